@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Bump-pointer arena that carves allocations out of large chunks. Sizes are rounded up to a
+// power of two and freed blocks are recycled through per-class free lists, so the steady
+// grow/shrink pattern of order-book levels stops touching the global heap after warm-up.
+// Not thread-safe; intended to be shared by the levels of a single instrument.
+class Arena {
+ public:
+  explicit Arena(std::size_t chunk_bytes = 256 * 1024) : chunk_bytes_(chunk_bytes) {}
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  ~Arena() {
+    for (void* chunk : chunks_) {
+      ::operator delete(chunk, std::align_val_t{kAlignment});
+    }
+  }
+
+  void* allocate(std::size_t bytes, std::size_t alignment) {
+    assert(alignment <= kAlignment);
+    (void)alignment;
+    const std::size_t size_class = class_of(bytes);
+    if (FreeNode* node = free_lists_[size_class]) {
+      free_lists_[size_class] = node->next;
+      return node;
+    }
+    const std::size_t rounded = std::size_t{1} << size_class;
+    if (rounded > static_cast<std::size_t>(chunk_end_ - cursor_)) {
+      refill(rounded);
+    }
+    void* result = cursor_;
+    cursor_ += rounded;
+    return result;
+  }
+
+  void deallocate(void* ptr, std::size_t bytes, std::size_t /*alignment*/) {
+    const std::size_t size_class = class_of(bytes);
+    auto* node = static_cast<FreeNode*>(ptr);
+    node->next = free_lists_[size_class];
+    free_lists_[size_class] = node;
+  }
+
+  std::size_t reserved_bytes() const { return reserved_bytes_; }
+
+ private:
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  static constexpr std::size_t kAlignment = alignof(std::max_align_t);
+  static constexpr std::size_t kMinClass = static_cast<std::size_t>(std::bit_width(kAlignment - 1));
+
+  static std::size_t class_of(std::size_t bytes) {
+    return bytes <= kAlignment ? kMinClass : static_cast<std::size_t>(std::bit_width(bytes - 1));
+  }
+
+  void refill(std::size_t min_bytes) {
+    const std::size_t bytes = min_bytes > chunk_bytes_ ? min_bytes : chunk_bytes_;
+    auto* chunk = static_cast<std::byte*>(::operator new(bytes, std::align_val_t{kAlignment}));
+    chunks_.push_back(chunk);
+    reserved_bytes_ += bytes;
+    cursor_ = chunk;
+    chunk_end_ = chunk + bytes;
+  }
+
+  std::size_t chunk_bytes_;
+  std::size_t reserved_bytes_{0};
+  std::byte* cursor_{nullptr};
+  std::byte* chunk_end_{nullptr};
+  std::array<FreeNode*, 64> free_lists_{};
+  std::vector<void*> chunks_;
+};
+
+// Stateful allocator handing out memory from a shared Arena. Copies compare equal when they
+// point at the same arena, which lets containers moved between levels keep their storage.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* ptr, std::size_t n) { arena_->deallocate(ptr, n * sizeof(T), alignof(T)); }
+
+  Arena* arena() const { return arena_; }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return arena_ == other.arena();
+  }
+
+ private:
+  Arena* arena_;
+};
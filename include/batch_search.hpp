@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Batched id lookups. A single binary search is a chain of dependent cache misses; running a
+// group of searches in lock-step lets each step issue the next probe's prefetch for every query
+// in the group before any of them needs it, so up to `batch` misses are in flight at once.
+inline constexpr std::size_t kMaxFindBatch = 32;
+inline constexpr std::size_t kDefaultFindBatch = 16;
+
+// Lower-bound positions of `ids` in a sorted sequence of `n` elements reached through `at(i)`,
+// which returns a pointer to element i (so the probe can be prefetched). All searches in a
+// group share the same length schedule; only their bases differ, and each level is a cmove.
+template <typename At>
+void lockstep_lower_bound(std::size_t n,
+                          At at,
+                          std::span<const std::uint64_t> ids,
+                          std::span<std::size_t> out,
+                          std::size_t batch = kDefaultFindBatch) {
+  batch = std::clamp<std::size_t>(batch, 1, kMaxFindBatch);
+  if (n == 0) {
+    std::fill(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(ids.size()), 0);
+    return;
+  }
+  std::size_t base[kMaxFindBatch];
+  for (std::size_t first = 0; first < ids.size(); first += batch) {
+    const std::size_t count = std::min(batch, ids.size() - first);
+    const std::uint64_t* keys = ids.data() + first;
+    std::fill(base, base + count, 0);
+    std::size_t len = n;
+    while (len > 1) {
+      const std::size_t half = len / 2;
+      const std::size_t next_len = len - half;
+      for (std::size_t j = 0; j < count; ++j) {
+        const std::size_t probe = base[j] + half;
+        base[j] = (at(probe)->id < keys[j]) ? probe : base[j];
+        if (next_len > 1) {
+          __builtin_prefetch(at(base[j] + next_len / 2));
+        }
+      }
+      len = next_len;
+    }
+    for (std::size_t j = 0; j < count; ++j) {
+      out[first + j] = base[j] + (at(base[j])->id < keys[j]);
+    }
+  }
+}
+
+// find for each id over a sorted contiguous range: out[i] is the index of the element whose id
+// equals ids[i], or sorted.size() when there is none.
+template <typename T>
+void find_many(std::span<const T> sorted,
+               std::span<const std::uint64_t> ids,
+               std::span<std::size_t> out,
+               std::size_t batch = kDefaultFindBatch) {
+  const T* data = sorted.data();
+  const auto at = [data](std::size_t i) { return data + i; };
+  lockstep_lower_bound(sorted.size(), at, ids, out, batch);
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    if (out[i] < sorted.size() && data[out[i]].id != ids[i]) {
+      out[i] = sorted.size();
+    }
+  }
+}
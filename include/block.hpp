@@ -3,30 +3,112 @@
 #include <array>
 #include <cassert>
 #include <cstddef>
-#include <cstring>
+#include <cstdint>
+#include <iterator>
 #include <new>
 #include <type_traits>
 #include <utility>
 
 template <typename T, std::size_t Capacity = 64>
 class Block {
-  static_assert(Capacity > 0, "Block capacity must be positive");
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "Block capacity must be a power of two so slots wrap with a mask");
   static_assert(std::is_trivially_copyable_v<T>,
-                "Block requires trivially copyable value types for memmove-based shifts");
+                "Block requires trivially copyable value types for copy-based shifts");
   static_assert(std::is_trivially_destructible_v<T>,
                 "Block requires trivially destructible value types");
 
  public:
   using value_type = T;
   using size_type = std::size_t;
-  using iterator = T*;
-  using const_iterator = const T*;
+
+  // Iterators carry the storage base, the head and a logical index, so dereference is one
+  // masked add and distance and ordering are plain index arithmetic.
+  template <bool IsConst>
+  class iterator_base {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+
+    iterator_base() = default;
+
+    template <bool B = IsConst, typename = std::enable_if_t<B>>
+    iterator_base(const iterator_base<false>& other)
+        : data_(other.data_), head_(other.head_), index_(other.index_) {}
+
+    reference operator*() const { return data_[(head_ + index_) & kMask]; }
+    pointer operator->() const { return &**this; }
+
+    iterator_base& operator++() {
+      ++index_;
+      return *this;
+    }
+    iterator_base operator++(int) {
+      iterator_base tmp = *this;
+      ++index_;
+      return tmp;
+    }
+    iterator_base& operator--() {
+      --index_;
+      return *this;
+    }
+    iterator_base operator--(int) {
+      iterator_base tmp = *this;
+      --index_;
+      return tmp;
+    }
+    iterator_base& operator+=(difference_type n) {
+      index_ += static_cast<size_type>(n);
+      return *this;
+    }
+    iterator_base& operator-=(difference_type n) { return *this += -n; }
+    iterator_base operator+(difference_type n) const {
+      iterator_base tmp = *this;
+      tmp += n;
+      return tmp;
+    }
+    iterator_base operator-(difference_type n) const {
+      iterator_base tmp = *this;
+      tmp -= n;
+      return tmp;
+    }
+    difference_type operator-(const iterator_base& other) const {
+      return static_cast<difference_type>(index_ - other.index_);
+    }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    bool operator==(const iterator_base& other) const { return index_ == other.index_; }
+    bool operator!=(const iterator_base& other) const { return !(*this == other); }
+    bool operator<(const iterator_base& other) const { return index_ < other.index_; }
+    bool operator>(const iterator_base& other) const { return other < *this; }
+    bool operator<=(const iterator_base& other) const { return !(other < *this); }
+    bool operator>=(const iterator_base& other) const { return !(*this < other); }
+
+   private:
+    friend class Block;
+
+    iterator_base(pointer data, size_type head, size_type index)
+        : data_(data), head_(head), index_(index) {}
+
+    pointer data_{nullptr};
+    size_type head_{0};
+    size_type index_{0};
+  };
+
+  using iterator = iterator_base<false>;
+  using const_iterator = iterator_base<true>;
+
   Block* next() { return next_; }
   Block* prev() { return prev_; }
   const Block* next() const { return next_; }
   const Block* prev() const { return prev_; }
   void set_next(Block* next) { next_ = next; }
   void set_prev(Block* prev) { prev_ = prev; }
+  std::int64_t sequence() const { return sequence_; }
+  void set_sequence(std::int64_t sequence) { sequence_ = sequence; }
 
   Block() = default;
 
@@ -35,10 +117,10 @@ class Block {
   bool empty() const { return size_ == 0; }
   bool full() const { return size_ == Capacity; }
 
-  iterator begin() { return data(); }
-  iterator end() { return data() + size_; }
-  const_iterator begin() const { return data(); }
-  const_iterator end() const { return data() + size_; }
+  iterator begin() { return iterator(data(), head_, 0); }
+  iterator end() { return iterator(data(), head_, size_); }
+  const_iterator begin() const { return const_iterator(data(), head_, 0); }
+  const_iterator end() const { return const_iterator(data(), head_, size_); }
   const_iterator cbegin() const { return begin(); }
   const_iterator cend() const { return end(); }
 
@@ -66,9 +148,7 @@ class Block {
   template <typename... Args>
   T& emplace_front(Args&&... args) {
     assert(!full());
-    if (size_ > 0) {
-      std::memmove(slot(1), slot(0), size_ * sizeof(T));
-    }
+    head_ = (head_ - 1) & kMask;
     new (slot(0)) T(std::forward<Args>(args)...);
     ++size_;
     total_volume_ += front().volume;
@@ -88,28 +168,48 @@ class Block {
   void pop_front() {
     assert(!empty());
     const auto removed_volume = front().volume;
-    const size_type tail_count = size_ - 1;
-    if (tail_count > 0) {
-      std::memmove(slot(0), slot(1), tail_count * sizeof(T));
-    }
     total_volume_ -= removed_volume;
     --size_;
+    head_ = (size_ == 0) ? 0 : (head_ + 1) & kMask;
   }
 
   void clear() {
+    head_ = 0;
     size_ = 0;
     total_volume_ = 0;
   }
 
+  // Closes the gap by shifting whichever side of `index` holds fewer elements.
   void erase(size_type index) {
     assert(index < size_);
     const auto removed_volume = (*this)[index].volume;
     const size_type tail_count = size_ - index - 1;
-    if (tail_count > 0) {
-      std::memmove(slot(index), slot(index + 1), tail_count * sizeof(T));
+    if (index < tail_count) {
+      for (size_type i = index; i > 0; --i) {
+        *slot(i) = *slot(i - 1);
+      }
+      head_ = (head_ + 1) & kMask;
+    } else {
+      for (size_type i = index; i < size_ - 1; ++i) {
+        *slot(i) = *slot(i + 1);
+      }
     }
     total_volume_ -= removed_volume;
     --size_;
+    if (size_ == 0) {
+      head_ = 0;
+    }
+  }
+
+  // Hints the cache line holding the element at `index` (which must be below capacity()).
+  void prefetch(size_type index) const { __builtin_prefetch(slot(index)); }
+
+  // Changes the volume of the element at `index` in place, keeping total_volume() exact.
+  void set_volume(size_type index, std::int64_t volume) {
+    assert(index < size_);
+    T& element = (*this)[index];
+    total_volume_ += volume - static_cast<std::int64_t>(element.volume);
+    element.volume = static_cast<decltype(std::declval<T&>().volume)>(volume);
   }
 
   template <typename Predicate>
@@ -138,11 +238,17 @@ class Block {
   T* data() { return reinterpret_cast<T*>(storage_.data()); }
   const T* data() const { return reinterpret_cast<const T*>(storage_.data()); }
 
-  T* slot(size_type index) { return data() + index; }
-  const T* slot(size_type index) const { return data() + index; }
+  static constexpr size_type kMask = Capacity - 1;
+
+  T* slot(size_type index) { return data() + ((head_ + index) & kMask); }
+  const T* slot(size_type index) const { return data() + ((head_ + index) & kMask); }
 
   Block* prev_{nullptr};
   Block* next_{nullptr};
+  std::int64_t sequence_{0};
+  // Live elements occupy storage slots head_ + i (mod Capacity) for i < size_, so pushes and
+  // pops at either end only move head_ or size_ and never shift the live range.
+  size_type head_{0};
   size_type size_{0};
   std::int64_t total_volume_{0};
   std::array<std::aligned_storage_t<sizeof(T), alignof(T)>, Capacity> storage_{};
@@ -1,42 +1,151 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <span>
 #include <type_traits>
 #include <utility>
 
-#include <absl/container/flat_hash_map.h>
-
+#include "batch_search.hpp"
 #include "block.hpp"
-
-template <typename T, std::size_t BlockCapacity = 64>
+#include "finger_cache.hpp"
+#include "galloping_search.hpp"
+#include "id_window_index.hpp"
+#include "interpolation_search.hpp"
+#include "vec_deque.hpp"
+
+// A non-zero FingerSlots makes the non-const find/erase_by_id/set_volume_by_id remember the
+// block and slot of the last FingerSlots ids they resolved and check those before the id
+// index. Const lookups never read or write the cache, so concurrent const reads stay race-free.
+template <typename T,
+          std::size_t BlockCapacity = 64,
+          typename Allocator = std::allocator<T>,
+          std::size_t FingerSlots = 0>
 class VolumeBreakdown {
   static_assert(std::is_convertible_v<decltype(std::declval<T&>().id), std::uint64_t>,
                 "VolumeBreakdown requires value_type.id convertible to uint64_t");
 
   using BlockType = Block<T, BlockCapacity>;
+  // Blocks and the id index both draw from the user's allocator (or pmr resource).
+  using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<BlockType>;
+  using BlockAllocTraits = std::allocator_traits<BlockAllocator>;
+  // The id index maps each live id to a 32-bit block tag (the block's sequence number) through
+  // a direct-mapped window, 4 bytes per id; tags map back to blocks through a second window
+  // with one slot per block.
+  using BlockTag = std::uint32_t;
+  static constexpr BlockTag kNoBlock = std::numeric_limits<BlockTag>::max();
+  static constexpr std::int64_t kFirstBlockSequence = std::int64_t{1} << 31;
+  // Sequences stay in [0, kSequenceLimit) so every tag is exact and none equals kNoBlock; a
+  // book that keeps growing at one end renumbers its blocks before leaving that range.
+  static constexpr std::int64_t kSequenceLimit = kNoBlock;
+  using IdIndex = IdWindowIndex<BlockTag, kNoBlock, Allocator>;
+  using BlockTable = IdWindowIndex<BlockType*, static_cast<BlockType*>(nullptr), Allocator>;
+  // Allocated the first time the index activates, so single-block queues stay small.
+  struct IndexState {
+    explicit IndexState(const Allocator& alloc) : ids(alloc), blocks(alloc) {}
+    IdIndex ids;
+    BlockTable blocks;
+  };
+  using IndexStateAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<IndexState>;
+  using IndexStateAllocTraits = std::allocator_traits<IndexStateAllocator>;
+  // Live blocks in list order, so id searches can jump to a block instead of walking links.
+  using DirectoryAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<BlockType*>;
+  using BlockDirectory = VecDeque<BlockType*, DirectoryAllocator>;
+  // One mutation as VolumeCursors replay it: an element inserted, erased or resized at
+  // `index` of the block with `sequence`, or that block removed. `volume` is the inserted or
+  // erased volume, or the resize delta.
+  struct CursorEvent {
+    enum class Kind : std::uint8_t { Insert, Erase, Resize, RemoveBlock };
+    Kind kind{Kind::Insert};
+    std::size_t index{0};
+    std::int64_t sequence{0};
+    std::int64_t volume{0};
+  };
+  // The last kCursorLogSize mutations, allocated by the first volume_cursor() call.
+  static constexpr std::size_t kCursorLogSize = 64;
+  struct CursorLog {
+    std::array<CursorEvent, kCursorLogSize> events{};
+  };
+  using CursorLogAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<CursorLog>;
+  using CursorLogAllocTraits = std::allocator_traits<CursorLogAllocator>;
+  // Position for cumulative-volume searches. `base` is the volume held by all blocks before
+  // `block`; `before` is the volume held by all elements before (`block`, `offset`).
+  struct VolumePosition {
+    BlockType* block{nullptr};
+    std::size_t offset{0};
+    std::int64_t base{0};
+    std::int64_t before{0};
+  };
 
  public:
   using value_type = T;
+  using allocator_type = Allocator;
   using size_type = std::size_t;
 
   VolumeBreakdown() = default;
+  explicit VolumeBreakdown(const Allocator& alloc)
+      : block_alloc_(alloc),
+        block_directory_(DirectoryAllocator(alloc)) {}
   VolumeBreakdown(const VolumeBreakdown&) = delete;
   VolumeBreakdown& operator=(const VolumeBreakdown&) = delete;
 
-  VolumeBreakdown(VolumeBreakdown&& other) noexcept { move_from(std::move(other)); }
-  VolumeBreakdown& operator=(VolumeBreakdown&& other) noexcept {
+  VolumeBreakdown(VolumeBreakdown&& other) noexcept
+      : block_alloc_(other.block_alloc_),
+        block_directory_(DirectoryAllocator(other.block_alloc_)) {
+    move_from(std::move(other));
+  }
+  // Allocator-extended move, used by allocator-aware containers of breakdowns (e.g. a pmr map
+  // rehashing). Blocks are adopted when the allocators compare equal and moved element-wise
+  // otherwise.
+  VolumeBreakdown(VolumeBreakdown&& other, const Allocator& alloc) : VolumeBreakdown(alloc) {
+    if (block_alloc_ == other.block_alloc_) {
+      move_from(std::move(other));
+    } else {
+      for (auto& value : other) {
+        emplace_back(std::move(value));
+      }
+      other.clear();
+    }
+  }
+  VolumeBreakdown& operator=(VolumeBreakdown&& other) noexcept(
+      BlockAllocTraits::propagate_on_container_move_assignment::value ||
+      BlockAllocTraits::is_always_equal::value) {
     if (this != &other) {
       clear();
-      move_from(std::move(other));
+      destroy_index_state();
+      destroy_cursor_log();
+      if constexpr (BlockAllocTraits::propagate_on_container_move_assignment::value) {
+        block_alloc_ = std::move(other.block_alloc_);
+        move_from(std::move(other));
+      } else if (block_alloc_ == other.block_alloc_) {
+        move_from(std::move(other));
+      } else {
+        // Blocks owned by a different resource cannot be adopted; move element-wise.
+        for (auto& value : other) {
+          emplace_back(std::move(value));
+        }
+        other.clear();
+      }
     }
     return *this;
   }
 
-  ~VolumeBreakdown() { clear(); }
+  ~VolumeBreakdown() {
+    clear();
+    destroy_index_state();
+    destroy_cursor_log();
+  }
+
+  allocator_type get_allocator() const { return allocator_type(block_alloc_); }
 
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
@@ -45,12 +154,15 @@ class VolumeBreakdown {
     BlockType* block = head_;
     while (block) {
       BlockType* next = block->next();
-      delete block;
+      destroy_block(block);
       block = next;
     }
     head_ = tail_ = nullptr;
     size_ = 0;
     block_count_ = 0;
+    reset_cursors();
+    fingers_.clear();
+    block_directory_.clear();
     deactivate_index();
   }
 
@@ -81,6 +193,7 @@ class VolumeBreakdown {
     value_type& result = block->emplace_back(std::forward<Args>(args)...);
     ++size_;
     on_insert(block, result);
+    record(CursorEvent::Kind::Insert, block, block->size() - 1, result.volume);
     return result;
   }
 
@@ -93,6 +206,7 @@ class VolumeBreakdown {
     value_type& result = block->emplace_front(std::forward<Args>(args)...);
     ++size_;
     on_insert(block, result);
+    record(CursorEvent::Kind::Insert, block, 0, result.volume);
     return result;
   }
 
@@ -100,6 +214,7 @@ class VolumeBreakdown {
     assert(!empty());
     BlockType* block = tail_;
     const std::uint64_t id = block->back().id;
+    record(CursorEvent::Kind::Erase, block, block->size() - 1, block->back().volume);
     block->pop_back();
     --size_;
     on_remove(id);
@@ -112,6 +227,7 @@ class VolumeBreakdown {
     assert(!empty());
     BlockType* block = head_;
     const std::uint64_t id = block->front().id;
+    record(CursorEvent::Kind::Erase, block, 0, block->front().volume);
     block->pop_front();
     --size_;
     on_remove(id);
@@ -212,7 +328,7 @@ class VolumeBreakdown {
     if (!pos.block_) {
       return end();
     }
-    return erase_at(pos.block_, pos.index_);
+    return erase_at(const_cast<BlockType*>(pos.block_), pos.index_);
   }
 
   iterator erase(iterator pos) { return erase(static_cast<const_iterator>(pos)); }
@@ -226,6 +342,20 @@ class VolumeBreakdown {
     return true;
   }
 
+  // Changes the volume of order `id` without moving it, as a modify-down that keeps queue
+  // priority does. Elements must not have their volume written through iterators, which would
+  // leave the block totals stale.
+  bool set_volume_by_id(std::uint64_t id, std::int64_t volume) {
+    auto loc = locate_by_id(id);
+    if (!loc.block) {
+      return false;
+    }
+    record(CursorEvent::Kind::Resize, loc.block, loc.index,
+           volume - (*loc.block)[loc.index].volume);
+    loc.block->set_volume(loc.index, volume);
+    return true;
+  }
+
   iterator begin() { return iterator(this, head_, 0); }
   iterator end() { return iterator(this, nullptr, 0); }
   const_iterator begin() const { return const_iterator(this, head_, 0); }
@@ -249,8 +379,128 @@ class VolumeBreakdown {
     return const_iterator(this, loc.block, loc.index);
   }
 
+  // Lookup and hit counts of the finger cache (both zero when FingerSlots is 0).
+  const auto& finger_cache() const { return fingers_; }
+
+  // First element whose id is not less than `id`, or end(). Interpolates over the block
+  // directory by each block's last id, then inside the chosen block's slots, instead of
+  // walking block links; misses resolve to their insertion point like lower_bound.
+  iterator interpolation_lower_bound_by_id(std::uint64_t id) {
+    auto loc = interpolation_locate(id);
+    return iterator(this, loc.block, loc.index);
+  }
+
+  const_iterator interpolation_lower_bound_by_id(std::uint64_t id) const {
+    auto loc = interpolation_locate(id);
+    return const_iterator(this, loc.block, loc.index);
+  }
+
+  // First element whose id is not less than `id`, or end(). Walks blocks from the tail (or the
+  // head, if `id` is nearer the oldest id) and gallops inside the block from its nearer end, so
+  // lookups of recently added orders only touch the last few blocks.
+  iterator gallop_lower_bound_by_id(std::uint64_t id) {
+    auto loc = gallop_locate(id);
+    return iterator(this, loc.block, loc.index);
+  }
+
+  const_iterator gallop_lower_bound_by_id(std::uint64_t id) const {
+    auto loc = gallop_locate(id);
+    return const_iterator(this, loc.block, loc.index);
+  }
+
+  // Batched find: out[i] = find(ids[i]). While the id index is active the lookups run in
+  // groups of `batch`, one stage per dependent load, so the misses of a group overlap: prefetch
+  // every id's index slot; resolve each to its block and prefetch the block header; prefetch
+  // the block's front and back elements; interpolate the id's slot between them and prefetch
+  // that line; then search the block outward from it.
+  void find_many(std::span<const std::uint64_t> ids,
+                 std::span<const_iterator> out,
+                 size_type batch = kDefaultFindBatch) const {
+    if (!index_active_) {
+      for (size_type i = 0; i < ids.size(); ++i) {
+        out[i] = find(ids[i]);
+      }
+      return;
+    }
+    batch = std::clamp<size_type>(batch, 1, kMaxFindBatch);
+    BlockType* blocks[kMaxFindBatch];
+    size_type probes[kMaxFindBatch];
+    for (size_type first = 0; first < ids.size(); first += batch) {
+      const size_type count = std::min(batch, ids.size() - first);
+      for (size_type j = 0; j < count; ++j) {
+        index_->ids.prefetch(ids[first + j]);
+      }
+      for (size_type j = 0; j < count; ++j) {
+        const BlockTag tag = index_->ids.find(ids[first + j]);
+        blocks[j] = tag == kNoBlock ? nullptr : index_->blocks.find(tag);
+        if (blocks[j]) {
+          __builtin_prefetch(blocks[j]);
+        }
+      }
+      for (size_type j = 0; j < count; ++j) {
+        if (blocks[j]) {
+          blocks[j]->prefetch(0);
+          blocks[j]->prefetch(blocks[j]->size() - 1);
+        }
+      }
+      for (size_type j = 0; j < count; ++j) {
+        if (blocks[j]) {
+          probes[j] = estimate_slot(blocks[j], ids[first + j]);
+          blocks[j]->prefetch(probes[j]);
+        }
+      }
+      for (size_type j = 0; j < count; ++j) {
+        const Location loc = locate_near(blocks[j], ids[first + j], probes[j]);
+        out[first + j] = loc.block ? const_iterator(this, loc.block, loc.index) : end();
+      }
+    }
+  }
+
+  // Caller-owned position for a run of volume_range calls at nearby thresholds: each call
+  // resumes from where the previous one left the cursor. Cursors from volume_cursor() follow
+  // the book through mutations: the breakdown logs its last kCursorLogSize mutations, and a
+  // cursor replays the ones since its last use, shifting its offset and volume sums for
+  // those in front of it. A cursor that fell behind the log, whose block was removed, or whose
+  // breakdown was cleared, moved or renumbered restarts from the head. Like an iterator, a
+  // cursor must not outlive its breakdown, and each thread needs its own.
+  class VolumeCursor {
+   public:
+    VolumeCursor() = default;
+
+   private:
+    friend class VolumeBreakdown;
+    const VolumeBreakdown* owner_{nullptr};
+    std::uint64_t version_{0};
+    std::int64_t sequence_{0};  // of position_.block, for matching logged mutations
+    VolumePosition position_{};
+  };
+
+  // A cursor at the head that later mutations keep exact. Starts the mutation log on first use.
+  VolumeCursor volume_cursor() {
+    if (!cursor_log_) {
+      CursorLogAllocator alloc(block_alloc_);
+      cursor_log_ = CursorLogAllocTraits::allocate(alloc, 1);
+      CursorLogAllocTraits::construct(alloc, cursor_log_);
+      log_start_ = version_;
+    }
+    VolumeCursor cursor;
+    cursor.owner_ = this;
+    cursor.version_ = version_;
+    return cursor;
+  }
+
+  // Elements whose inclusive cumulative volume falls in [lower, upper]. The end search
+  // continues from the start result rather than from the head.
   std::pair<const_iterator, const_iterator> volume_range(std::int64_t lower,
                                                          std::int64_t upper) const {
+    VolumeCursor cursor;
+    return volume_range(cursor, lower, upper);
+  }
+
+  std::pair<const_iterator, const_iterator> volume_range(VolumeCursor& cursor,
+                                                         std::int64_t lower,
+                                                         std::int64_t upper) const {
+    catch_up(cursor);
     if (lower <= 0) {
       lower = 1;
     }
@@ -259,8 +509,12 @@ class VolumeBreakdown {
     }
     const std::int64_t end_target =
         (upper == std::numeric_limits<std::int64_t>::max()) ? upper : upper + 1;
-    auto start = find_position_by_volume(lower);
-    auto finish = find_position_by_volume(end_target);
+    auto start = find_position_by_volume(cursor.position_, lower);
+    if (cursor.position_.block) {
+      cursor.sequence_ = cursor.position_.block->sequence();
+    }
+    VolumePosition end_position = cursor.position_;
+    auto finish = find_position_by_volume(end_position, end_target);
     return {const_iterator(this, start.first, start.second),
             const_iterator(this, finish.first, finish.second)};
   }
@@ -285,6 +539,7 @@ class VolumeBreakdown {
  private:
   iterator erase_at(BlockType* block, size_type index) {
     const std::uint64_t id = (*block)[index].id;
+    record(CursorEvent::Kind::Erase, block, index, (*block)[index].volume);
     block->erase(index);
     --size_;
     on_remove(id);
@@ -305,15 +560,20 @@ class VolumeBreakdown {
 
   BlockType* ensure_head_block() {
     if (!head_) {
-      BlockType* block = create_block();
+      BlockType* block = create_block(kFirstBlockSequence);
       head_ = tail_ = block;
+      block_directory_.push_back(block);
       return block;
     }
     if (head_->full()) {
-      BlockType* block = create_block();
+      if (head_->sequence() == 0) {
+        renumber_blocks();
+      }
+      BlockType* block = create_block(head_->sequence() - 1);
       block->set_next(head_);
       head_->set_prev(block);
       head_ = block;
+      block_directory_.push_front(block);
       return block;
     }
     return head_;
@@ -321,30 +581,66 @@ class VolumeBreakdown {
 
   BlockType* ensure_tail_block() {
     if (!tail_) {
-      BlockType* block = create_block();
+      BlockType* block = create_block(kFirstBlockSequence);
       head_ = tail_ = block;
+      block_directory_.push_back(block);
       return block;
     }
     if (tail_->full()) {
-      BlockType* block = create_block();
+      if (tail_->sequence() + 1 == kSequenceLimit) {
+        renumber_blocks();
+      }
+      BlockType* block = create_block(tail_->sequence() + 1);
       block->set_prev(tail_);
       tail_->set_next(block);
       tail_ = block;
+      block_directory_.push_back(block);
       return block;
     }
     return tail_;
   }
 
-  BlockType* create_block() {
-    BlockType* block = new BlockType();
+  BlockType* create_block(std::int64_t sequence) {
+    assert(sequence >= 0 && sequence < kSequenceLimit);
+    BlockType* block = BlockAllocTraits::allocate(block_alloc_, 1);
+    BlockAllocTraits::construct(block_alloc_, block);
+    block->set_sequence(sequence);
     ++block_count_;
     activate_index_if_needed();
+    if (index_active_) {
+      index_->blocks.insert_or_assign(tag_of(block), block);
+    }
     return block;
   }
 
+  // Gives the blocks consecutive sequences centred on kFirstBlockSequence, keeping their order
+  // (which the directory relies on), and re-keys the index under the new
+  // tags. Only a book that grows about 2^31 blocks at one end without emptying gets here.
+  void renumber_blocks() {
+    std::int64_t sequence = kFirstBlockSequence - static_cast<std::int64_t>(block_count_ / 2);
+    for (BlockType* block = head_; block; block = block->next()) {
+      block->set_sequence(sequence++);
+    }
+    reset_cursors();
+    if (index_active_) {
+      rebuild_index();
+    }
+  }
+
   void remove_block(BlockType* block) {
+    record(CursorEvent::Kind::RemoveBlock, block, 0, 0);
     BlockType* prev = block->prev();
     BlockType* next = block->next();
+    if (!prev) {
+      block_directory_.pop_front();
+    } else if (!next) {
+      block_directory_.pop_back();
+    } else {
+      // The directory is ordered by sequence number, so a middle block is found by bisection.
+      block_directory_.erase(block_directory_.lower_bound(
+          block->sequence(),
+          [](const BlockType* entry, std::int64_t seq) { return entry->sequence() < seq; }));
+    }
     if (prev) {
       prev->set_next(next);
     } else {
@@ -355,29 +651,147 @@ class VolumeBreakdown {
     } else {
       tail_ = prev;
     }
-    delete block;
+    if (index_active_) {
+      index_->blocks.erase(tag_of(block));
+    }
+    fingers_.forget_if([block](const Location& finger) { return finger.block == block; });
+    destroy_block(block);
     --block_count_;
     if (block_count_ <= 1) {
       deactivate_index();
     }
   }
 
+  void destroy_block(BlockType* block) {
+    BlockAllocTraits::destroy(block_alloc_, block);
+    BlockAllocTraits::deallocate(block_alloc_, block, 1);
+  }
+
   struct Location {
     BlockType* block{nullptr};
     size_type index{0};
   };
 
+  static BlockTag tag_of(const BlockType* block) { return static_cast<BlockTag>(block->sequence()); }
+
   Location locate_by_id(std::uint64_t id) const {
     if (index_active_) {
-      auto it = block_index_.find(id);
-      if (it == block_index_.end()) {
+      const BlockTag tag = index_->ids.find(id);
+      if (tag == kNoBlock) {
         return {};
       }
-      return locate_within_block(it->second, id);
+      return locate_within_block(index_->blocks.find(tag), id);
     }
     return locate_within_block(head_, id);
   }
 
+  // locate_by_id for the non-const lookups, trying the finger cache first.
+  Location locate_by_id(std::uint64_t id) {
+    if (const Location* finger = fingers_.find(id)) {
+      if (finger->block && finger->index < finger->block->size() &&
+          (*finger->block)[finger->index].id == id) {
+        fingers_.record_hit();
+        return *finger;
+      }
+    }
+    const Location loc = std::as_const(*this).locate_by_id(id);
+    if (loc.block) {
+      fingers_.remember(id, loc);
+    }
+    return loc;
+  }
+
+  // Debug check for the searches that assume the queue is in id order.
+  bool sorted_by_id() const {
+    return std::is_sorted(begin(), end(), [](const value_type& a, const value_type& b) {
+      return a.id < b.id;
+    });
+  }
+
+  Location interpolation_locate(std::uint64_t id) const {
+    assert(sorted_by_id());
+    const auto [first, second] = block_directory_.as_slices();
+    const auto last_id = [](const BlockType* block) -> std::uint64_t { return block->back().id; };
+    // Every block of the first segment ends below `id` exactly when the answer, if any, is in
+    // the wrapped segment.
+    std::span<BlockType* const> segment = first;
+    if (!first.empty() && last_id(first.back()) < id) {
+      segment = second;
+    }
+    const auto it = interpolation_lower_bound(segment.begin(), segment.end(), id, last_id);
+    if (it == segment.end()) {
+      return {};
+    }
+    BlockType* block = *it;
+    const auto pos = interpolation_lower_bound(
+        block->begin(), block->end(), id,
+        [](const value_type& value) -> std::uint64_t { return value.id; });
+    return Location{block, static_cast<size_type>(pos - block->begin())};
+  }
+
+  Location gallop_locate(std::uint64_t id) const {
+    assert(sorted_by_id());
+    if (!head_ || tail_->back().id < id) {
+      return {};
+    }
+    BlockType* block = nullptr;
+    if (id < head_->front().id || id - head_->front().id < tail_->back().id - id) {
+      block = head_;
+      while (block && block->back().id < id) {
+        block = block->next();
+      }
+      if (!block) {
+        return {};
+      }
+    } else {
+      block = tail_;
+      while (block->prev() && block->prev()->back().id >= id) {
+        block = block->prev();
+      }
+    }
+    const auto pos = gallop_lower_bound(
+        block->begin(), block->end(), id,
+        [](const value_type& value) -> std::uint64_t { return value.id; });
+    return Location{block, static_cast<size_type>(pos - block->begin())};
+  }
+
+  // Slot `id` would occupy if the block's ids ran evenly from its front to its back.
+  static size_type estimate_slot(const BlockType* block, std::uint64_t id) {
+    const std::uint64_t lo = block->front().id;
+    const std::uint64_t hi = block->back().id;
+    if (id <= lo || hi <= lo) {
+      return 0;
+    }
+    if (id >= hi) {
+      return block->size() - 1;
+    }
+    const double fraction = static_cast<double>(id - lo) / static_cast<double>(hi - lo);
+    return static_cast<size_type>(fraction * static_cast<double>(block->size() - 1));
+  }
+
+  // Walks from slot `start` towards `id` while the ids are in order, which finds it in a few
+  // slots when the estimate was close. Blocks whose ids are not sorted (a churned book reuses
+  // low ids) fall back to the full scan.
+  Location locate_near(BlockType* block, std::uint64_t id, size_type start) const {
+    if (!block) {
+      return {};
+    }
+    size_type i = start;
+    while (i + 1 < block->size() && (*block)[i].id < id) {
+      ++i;
+    }
+    while (i > 0 && (*block)[i].id > id) {
+      --i;
+    }
+    if ((*block)[i].id == id) {
+      while (i > 0 && (*block)[i - 1].id == id) {
+        --i;
+      }
+      return Location{block, i};
+    }
+    return locate_within_block(block, id);
+  }
+
   Location locate_within_block(BlockType* block, std::uint64_t id) const {
     if (!block) {
       return {};
@@ -390,42 +804,138 @@ class VolumeBreakdown {
     return {};
   }
 
-  std::pair<BlockType*, size_type> find_position_by_volume(std::int64_t target) const {
+  // Logs a mutation for the cursors, if any were handed out, and advances the version.
+  void record(typename CursorEvent::Kind kind,
+              const BlockType* block,
+              size_type index,
+              std::int64_t volume) {
+    if (cursor_log_) {
+      cursor_log_->events[version_ % kCursorLogSize] =
+          CursorEvent{kind, index, block->sequence(), volume};
+    }
+    ++version_;
+  }
+
+  // Sends every outstanding cursor back to the head: their blocks or sequences are gone.
+  void reset_cursors() {
+    ++version_;
+    log_start_ = version_;
+  }
+
+  // Replays the mutations since `cursor` was last used, the way they moved the elements and
+  // volumes in front of it, or restarts it from the head if they are no longer all logged.
+  void catch_up(VolumeCursor& cursor) const {
+    using Kind = typename CursorEvent::Kind;
+    if (cursor.owner_ != this || !cursor_log_ || cursor.version_ < log_start_ ||
+        version_ - cursor.version_ > kCursorLogSize) {
+      cursor.owner_ = this;
+      cursor.version_ = version_;
+      cursor.position_ = {};
+      return;
+    }
+    VolumePosition& position = cursor.position_;
+    for (; cursor.version_ != version_ && position.block; ++cursor.version_) {
+      const CursorEvent& event = cursor_log_->events[cursor.version_ % kCursorLogSize];
+      const std::int64_t signed_volume = event.kind == Kind::Erase ? -event.volume : event.volume;
+      if (event.sequence < cursor.sequence_) {
+        position.base += signed_volume;
+        position.before += signed_volume;
+      } else if (event.sequence == cursor.sequence_) {
+        switch (event.kind) {
+          case Kind::Insert:
+            if (event.index <= position.offset) {
+              ++position.offset;
+              position.before += event.volume;
+            }
+            break;
+          case Kind::Erase:
+            if (event.index < position.offset) {
+              --position.offset;
+              position.before -= event.volume;
+            }
+            break;
+          case Kind::Resize:
+            if (event.index < position.offset) {
+              position.before += event.volume;
+            }
+            break;
+          case Kind::RemoveBlock:
+            position = {};
+            break;
+        }
+      }
+    }
+    cursor.version_ = version_;
+  }
+
+  // Returns the first element whose inclusive cumulative volume reaches `target`, walking
+  // from wherever `position` was left and leaving it on the result.
+  std::pair<BlockType*, size_type> find_position_by_volume(VolumePosition& position,
+                                                           std::int64_t target) const {
     if (target <= 0) {
       return {head_, 0};
     }
-    BlockType* block = head_;
-    std::int64_t accumulated = 0;
-    while (block) {
-      const auto block_sum = block->total_volume();
-      if (block_sum > 0 && accumulated + block_sum >= target) {
-        for (size_type i = 0; i < block->size(); ++i) {
-          accumulated += (*block)[i].volume;
-          if (accumulated >= target) {
-            return {block, i};
-          }
-        }
+    if (!position.block) {
+      if (!head_) {
+        return {nullptr, 0};
+      }
+      position = VolumePosition{head_, 0, 0, 0};
+    }
+    BlockType* block = position.block;
+    if (target <= position.base) {
+      while (block->prev() && target <= position.base) {
+        block = block->prev();
+        position.base -= block->total_volume();
+      }
+      position.block = block;
+      position.offset = 0;
+      position.before = position.base;
+    } else if (target > position.base + block->total_volume()) {
+      while (block->next() && target > position.base + block->total_volume()) {
+        position.base += block->total_volume();
+        block = block->next();
       }
-      accumulated += block_sum;
-      block = block->next();
+      position.block = block;
+      position.offset = 0;
+      position.before = position.base;
+      if (target > position.base + block->total_volume()) {
+        return {nullptr, 0};
+      }
+    }
+    if (position.offset >= block->size()) {
+      position.offset = 0;
+      position.before = position.base;
+    }
+    while (position.offset > 0 && target <= position.before) {
+      --position.offset;
+      position.before -= (*block)[position.offset].volume;
+    }
+    while (position.before + (*block)[position.offset].volume < target) {
+      position.before += (*block)[position.offset].volume;
+      ++position.offset;
     }
-    return {nullptr, 0};
+    return {block, position.offset};
   }
 
   void on_insert(BlockType* block, const value_type& value) {
     if (index_active_) {
-      block_index_[value.id] = block;
+      index_->ids.insert_or_assign(value.id, tag_of(block));
     }
   }
 
   void on_remove(std::uint64_t id) {
     if (index_active_) {
-      block_index_.erase(id);
+      index_->ids.erase(id);
     }
   }
 
   void activate_index_if_needed() {
     if (block_count_ >= 2 && !index_active_) {
+      if (!index_) {
+        IndexStateAllocator alloc(block_alloc_);
+        index_ = IndexStateAllocTraits::allocate(alloc, 1);
+        IndexStateAllocTraits::construct(alloc, index_, Allocator(block_alloc_));
+      }
       rebuild_index();
       index_active_ = true;
     }
@@ -435,18 +945,41 @@ class VolumeBreakdown {
     if (!index_active_) {
       return;
     }
-    block_index_.clear();
+    index_->ids.clear();
+    index_->blocks.clear();
     index_active_ = false;
   }
 
+  void destroy_index_state() {
+    if (!index_) {
+      return;
+    }
+    IndexStateAllocator alloc(block_alloc_);
+    IndexStateAllocTraits::destroy(alloc, index_);
+    IndexStateAllocTraits::deallocate(alloc, index_, 1);
+    index_ = nullptr;
+  }
+
+  void destroy_cursor_log() {
+    if (!cursor_log_) {
+      return;
+    }
+    CursorLogAllocator alloc(block_alloc_);
+    CursorLogAllocTraits::destroy(alloc, cursor_log_);
+    CursorLogAllocTraits::deallocate(alloc, cursor_log_, 1);
+    cursor_log_ = nullptr;
+  }
+
   void rebuild_index() {
-    block_index_.clear();
+    index_->ids.clear();
+    index_->blocks.clear();
     if (block_count_ < 2) {
       return;
     }
     for (BlockType* block = head_; block; block = block->next()) {
+      index_->blocks.insert_or_assign(tag_of(block), block);
       for (size_type i = 0; i < block->size(); ++i) {
-        block_index_[(*block)[i].id] = block;
+        index_->ids.insert_or_assign((*block)[i].id, tag_of(block));
       }
     }
   }
@@ -457,18 +990,32 @@ class VolumeBreakdown {
     size_ = other.size_;
     block_count_ = other.block_count_;
     index_active_ = other.index_active_;
-    block_index_ = std::move(other.block_index_);
+    reset_cursors();
+    assert(!index_ && !cursor_log_);
+    index_ = std::exchange(other.index_, nullptr);
+    cursor_log_ = std::exchange(other.cursor_log_, nullptr);
+    block_directory_ = std::move(other.block_directory_);
     other.head_ = other.tail_ = nullptr;
+    other.reset_cursors();
     other.size_ = 0;
     other.block_count_ = 0;
     other.index_active_ = false;
-    other.block_index_.clear();
+    other.fingers_.clear();
+    other.block_directory_.clear();
   }
 
+  BlockAllocator block_alloc_{};
   BlockType* head_{nullptr};
   BlockType* tail_{nullptr};
   size_type size_{0};
   size_type block_count_{0};
   bool index_active_{false};
-  absl::flat_hash_map<std::uint64_t, BlockType*> block_index_;
+  // Counts mutations; the one that took the version from v is cursor_log_->events[v % size].
+  std::uint64_t version_{0};
+  // Cursors older than this version cannot replay the log and restart from the head.
+  std::uint64_t log_start_{0};
+  CursorLog* cursor_log_{nullptr};
+  IndexState* index_{nullptr};
+  BlockDirectory block_directory_{DirectoryAllocator(block_alloc_)};
+  [[no_unique_address]] FingerCache<Location, FingerSlots> fingers_;
 };
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "block_level.hpp"
+#include "order.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+struct BookEvent {
+  enum class Kind : std::uint8_t { Add, Cancel, Execute };
+
+  std::uint32_t symbol{};
+  Kind kind{Kind::Add};
+  Order order{};
+};
+
+// Owns one order queue per instrument and shards instruments across worker threads by symbol
+// hash. Each shard has a single writer thread (pinned to a core where supported), its own
+// memory pool for the books it owns and their hash map, and a lock-free SPSC ingress queue fed
+// by `submit`.
+class BookManager {
+ public:
+  using InstrumentAllocator = std::pmr::polymorphic_allocator<Order>;
+  using InstrumentBook = VolumeBreakdown<Order, 64, InstrumentAllocator>;
+
+  explicit BookManager(std::size_t shard_count,
+                       std::size_t ingress_capacity = 1 << 16,
+                       bool pin_threads = true);
+  ~BookManager();
+
+  BookManager(const BookManager&) = delete;
+  BookManager& operator=(const BookManager&) = delete;
+
+  std::size_t shard_count() const { return shards_.size(); }
+  std::size_t shard_for(std::uint32_t symbol) const;
+
+  // Core the producer should run on: the one just past the shards' cores, so with at most
+  // hardware_concurrency() - 1 shards no writer shares it.
+  std::size_t producer_core() const;
+
+  // Routes an event to its shard, spinning while that shard's ingress is full. Must only be
+  // called from a single producer thread.
+  void submit(const BookEvent& event);
+
+  // Blocks until every submitted event has been applied by its shard.
+  void flush();
+
+  std::uint64_t processed() const;
+
+  // Number of live orders across all books. Only meaningful after `flush()`.
+  std::size_t total_orders() const;
+
+ private:
+  struct Shard;
+
+  void run_shard(Shard& shard);
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<bool> running_{true};
+};
+
+// Pins the calling thread to `core` (modulo the core count) and restores its previous affinity
+// on destruction, so threads it starts afterwards are not left pinned. A no-op where thread
+// affinity is unsupported.
+class ScopedCorePin {
+ public:
+  explicit ScopedCorePin(std::size_t core);
+  ~ScopedCorePin();
+
+  ScopedCorePin(const ScopedCorePin&) = delete;
+  ScopedCorePin& operator=(const ScopedCorePin&) = delete;
+
+ private:
+  struct SavedAffinity;
+
+  std::unique_ptr<SavedAffinity> saved_;
+};
+
+// Deterministic multi-symbol add/cancel/execute stream. Ids are globally increasing so every
+// per-symbol queue stays sorted; cancels and executes only target orders that are still live.
+std::vector<BookEvent> make_book_stream(std::size_t symbols,
+                                        std::size_t count,
+                                        std::uint64_t seed);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "order.hpp"
+
+// 12-byte stand-in for Order (24 bytes with padding) inside a container whose orders share a
+// CompactOrderBase: id and exchangeTimestamp are stored as 32-bit offsets from the base, and
+// volume and isOwn share a word. Five orders fit a cache line instead of 2.67. `id` keeps its
+// name and order, so containers can search on it, but it is only comparable with ids
+// converted through the same base.
+struct CompactOrder {
+  std::uint32_t id{};
+  std::uint32_t exchangeTimestamp{};
+  std::uint32_t volume : 31 {};
+  std::uint32_t isOwn : 1 {};
+
+  friend bool operator==(const CompactOrder&, const CompactOrder&) = default;
+};
+
+static_assert(sizeof(CompactOrder) == 12);
+
+// Origin of a container's CompactOrder offsets. pack/unpack round-trip exactly for every order
+// that representable() accepts: ids and timestamps at most 2^32 - 1 above the base and
+// volumes in [0, 2^31).
+struct CompactOrderBase {
+  static constexpr std::uint64_t kMaxOffset = std::numeric_limits<std::uint32_t>::max();
+  static constexpr std::int64_t kMaxVolume = (std::int64_t{1} << 31) - 1;
+
+  std::uint64_t id{0};
+  std::uint64_t exchangeTimestamp{0};
+
+  // The lowest id and timestamp of `orders` (timestamps need not be sorted).
+  static CompactOrderBase covering(std::span<const Order> orders) {
+    if (orders.empty()) {
+      return {};
+    }
+    CompactOrderBase base{orders.front().id, orders.front().exchangeTimestamp};
+    for (const Order& order : orders) {
+      base.id = std::min(base.id, order.id);
+      base.exchangeTimestamp = std::min(base.exchangeTimestamp, order.exchangeTimestamp);
+    }
+    return base;
+  }
+
+  bool representable(const Order& order) const {
+    return order.id >= id && order.id - id <= kMaxOffset &&
+           order.exchangeTimestamp >= exchangeTimestamp &&
+           order.exchangeTimestamp - exchangeTimestamp <= kMaxOffset && order.volume >= 0 &&
+           order.volume <= kMaxVolume;
+  }
+
+  CompactOrder pack(const Order& order) const {
+    assert(representable(order));
+    CompactOrder out;
+    out.id = static_cast<std::uint32_t>(order.id - id);
+    out.exchangeTimestamp = static_cast<std::uint32_t>(order.exchangeTimestamp - exchangeTimestamp);
+    out.volume = static_cast<std::uint32_t>(order.volume);
+    out.isOwn = order.isOwn ? 1u : 0u;
+    return out;
+  }
+
+  Order unpack(const CompactOrder& order) const {
+    return Order{id + order.id, exchangeTimestamp + order.exchangeTimestamp,
+                 static_cast<std::int32_t>(order.volume), order.isOwn != 0};
+  }
+
+  // An id at or above the base in the containers' id space, for searches.
+  std::uint64_t relative_id(std::uint64_t order_id) const {
+    assert(order_id >= id);
+    return order_id - id;
+  }
+};
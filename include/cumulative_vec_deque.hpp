@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "vec_deque.hpp"
+
+// VecDeque of orders paired with a parallel ring of running volume totals. Totals are stored
+// in absolute terms; `base_` is the volume that has left through the front, so the logical
+// cumulative volume through element i is `cumulative_[i] - base_`. pop_front only moves
+// `base_`, and volume threshold queries are binary searches over the totals.
+//
+// Erasing from the middle adjusts the totals on the shorter side of the erased slot (the
+// front side by also moving `base_`), so it costs O(min(i, n - i)) like the element shift.
+// Elements are exposed read-only because changing a volume through them would desync the
+// totals; set_volume changes one and its totals together, at the same cost as an erase.
+template <typename T, typename Allocator = std::allocator<T>>
+class CumulativeVecDeque {
+  using TotalAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<std::int64_t>;
+  using Items = VecDeque<T, Allocator>;
+  using Totals = VecDeque<std::int64_t, TotalAllocator>;
+
+ public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using const_iterator = typename Items::const_iterator;
+  using iterator = const_iterator;
+
+  CumulativeVecDeque() = default;
+  explicit CumulativeVecDeque(const Allocator& alloc)
+      : items_(alloc), cumulative_(TotalAllocator(alloc)) {}
+
+  bool empty() const { return items_.empty(); }
+  size_type size() const { return items_.size(); }
+
+  const T& front() const { return items_.front(); }
+  const T& back() const { return items_.back(); }
+  const T& operator[](size_type index) const { return items_[index]; }
+
+  const_iterator begin() const { return items_.begin(); }
+  const_iterator end() const { return items_.end(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  std::int64_t total_volume() const { return empty() ? 0 : cumulative_.back() - base_; }
+
+  // Cumulative volume of elements [0, index].
+  std::int64_t cumulative_volume(size_type index) const { return cumulative_[index] - base_; }
+
+  void clear() {
+    items_.clear();
+    cumulative_.clear();
+    base_ = 0;
+  }
+
+  void push_back(const T& value) {
+    const std::int64_t before = empty() ? base_ : cumulative_.back();
+    items_.push_back(value);
+    cumulative_.push_back(before + value.volume);
+  }
+
+  void push_front(const T& value) {
+    const std::int64_t before = base_;
+    base_ -= value.volume;
+    items_.push_front(value);
+    cumulative_.push_front(before);
+  }
+
+  void pop_front() {
+    if (empty()) {
+      return;
+    }
+    base_ = cumulative_.front();
+    items_.pop_front();
+    cumulative_.pop_front();
+  }
+
+  void pop_back() {
+    if (empty()) {
+      return;
+    }
+    items_.pop_back();
+    cumulative_.pop_back();
+  }
+
+  const_iterator erase(const_iterator pos) {
+    const size_type idx = static_cast<size_type>(pos - begin());
+    if (idx >= size()) {
+      return end();
+    }
+    const std::int64_t volume = items_[idx].volume;
+    items_.erase(items_.begin() + static_cast<std::ptrdiff_t>(idx));
+    cumulative_.erase(cumulative_.begin() + static_cast<std::ptrdiff_t>(idx));
+    if (idx < size() / 2) {
+      base_ += volume;
+      for (size_type i = 0; i < idx; ++i) {
+        cumulative_[i] += volume;
+      }
+    } else {
+      for (size_type i = idx; i < size(); ++i) {
+        cumulative_[i] -= volume;
+      }
+    }
+    return begin() + static_cast<std::ptrdiff_t>(idx);
+  }
+
+  // Changes the volume at `pos`, moving the totals on the shorter side of it: the ones after it
+  // by the difference, or the ones before it and `base_` by minus the difference.
+  void set_volume(const_iterator pos, std::int64_t volume) {
+    const size_type idx = static_cast<size_type>(pos - begin());
+    if (idx >= size()) {
+      return;
+    }
+    T& element = items_[idx];
+    const std::int64_t delta = volume - static_cast<std::int64_t>(element.volume);
+    element.volume = static_cast<decltype(element.volume)>(volume);
+    if (idx < size() / 2) {
+      base_ -= delta;
+      for (size_type i = 0; i < idx; ++i) {
+        cumulative_[i] -= delta;
+      }
+    } else {
+      for (size_type i = idx; i < size(); ++i) {
+        cumulative_[i] += delta;
+      }
+    }
+  }
+
+  // First element whose inclusive cumulative volume reaches `target`.
+  const_iterator find_by_volume(std::int64_t target) const {
+    // base_ is negative after push_front, so the sum can overflow either way; it saturates
+    // towards the side `target` points to.
+    std::int64_t key;
+    if (__builtin_add_overflow(base_, target, &key)) {
+      key = target > 0 ? std::numeric_limits<std::int64_t>::max()
+                       : std::numeric_limits<std::int64_t>::min();
+    }
+    const auto it = cumulative_.lower_bound(
+        key, [](std::int64_t total, std::int64_t k) { return total < k; });
+    return begin() + (it - cumulative_.begin());
+  }
+
+  // Same contract as VolumeBreakdown::volume_range: elements whose cumulative volume falls in
+  // [lower, upper], found with two binary searches.
+  std::pair<const_iterator, const_iterator> volume_range(std::int64_t lower,
+                                                         std::int64_t upper) const {
+    if (lower <= 0) {
+      lower = 1;
+    }
+    if (upper < lower) {
+      upper = lower;
+    }
+    const std::int64_t end_target =
+        (upper == std::numeric_limits<std::int64_t>::max()) ? upper : upper + 1;
+    return {find_by_volume(lower), find_by_volume(end_target)};
+  }
+
+ private:
+  Items items_;
+  Totals cumulative_;
+  std::int64_t base_{0};
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// The last Slots ids a container resolved, with where it found them. Entries are only hints:
+// the owner checks that the remembered slot still holds the id before trusting one, so shifts
+// and overwrites just turn an entry into a miss. The owner must drop entries that point into
+// storage it frees (forget_if). Every member that counts or caches is non-const, so owners
+// only touch the cache from non-const lookups and concurrent const reads share no state.
+// Slots = 0 compiles the cache away.
+template <typename Location, std::size_t Slots>
+class FingerCache {
+ public:
+  static constexpr bool kEnabled = true;
+
+  // Remembered location of `id`, or nullptr. Counts one lookup.
+  const Location* find(std::uint64_t id) {
+    ++lookups_;
+    for (std::size_t i = 0; i < Slots; ++i) {
+      if (used_[i] && ids_[i] == id) {
+        return &locations_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  // Counts a find() result the owner validated.
+  void record_hit() { ++hits_; }
+
+  // Replaces the oldest entry, or refreshes the entry already holding `id`.
+  void remember(std::uint64_t id, const Location& location) {
+    for (std::size_t i = 0; i < Slots; ++i) {
+      if (used_[i] && ids_[i] == id) {
+        locations_[i] = location;
+        return;
+      }
+    }
+    ids_[next_] = id;
+    locations_[next_] = location;
+    used_[next_] = true;
+    next_ = next_ + 1 == Slots ? 0 : next_ + 1;
+  }
+
+  template <typename Pred>
+  void forget_if(Pred pred) {
+    for (std::size_t i = 0; i < Slots; ++i) {
+      if (used_[i] && pred(locations_[i])) {
+        used_[i] = false;
+      }
+    }
+  }
+
+  void clear() { used_.fill(false); }
+
+  std::uint64_t lookups() const { return lookups_; }
+  std::uint64_t hits() const { return hits_; }
+
+ private:
+  // Occupancy is tracked apart from the ids so that every id, UINT64_MAX included, is valid.
+  std::array<std::uint64_t, Slots> ids_{};
+  std::array<Location, Slots> locations_{};
+  std::array<bool, Slots> used_{};
+  std::size_t next_{0};
+  std::uint64_t lookups_{0};
+  std::uint64_t hits_{0};
+};
+
+template <typename Location>
+class FingerCache<Location, 0> {
+ public:
+  static constexpr bool kEnabled = false;
+
+  const Location* find(std::uint64_t) { return nullptr; }
+  void record_hit() {}
+  void remember(std::uint64_t, const Location&) {}
+  template <typename Pred>
+  void forget_if(Pred) {}
+  void clear() {}
+  std::uint64_t lookups() const { return 0; }
+  std::uint64_t hits() const { return 0; }
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+// lower_bound over a range sorted by an unsigned 64-bit key that starts at whichever end is
+// closer to the key by id distance and gallops inward: probe 1, 2, 4, ... slots from that end
+// until the probe crosses the key, then binary-search the last doubling. A key k slots from
+// the chosen end costs O(log k) probes, all near that end, so lookups that cluster on the
+// newest (or oldest) orders touch a few cache lines instead of the log2(n) spread of a full
+// binary search. The worst case is about twice std::lower_bound.
+template <typename RandomIt, typename Projection>
+RandomIt gallop_lower_bound(RandomIt first, RandomIt last, std::uint64_t key, Projection proj) {
+  assert(std::is_sorted(first, last,
+                        [&](const auto& a, const auto& b) { return proj(a) < proj(b); }));
+  const auto n = std::distance(first, last);
+  if (n == 0) {
+    return first;
+  }
+  const std::uint64_t front_key = proj(first[0]);
+  if (key <= front_key) {
+    return first;
+  }
+  const std::uint64_t back_key = proj(first[n - 1]);
+  if (key > back_key) {
+    return last;
+  }
+  // Invariant as in interpolation_lower_bound: proj(first[lo]) < key <= proj(first[hi]).
+  std::ptrdiff_t lo = 0;
+  std::ptrdiff_t hi = n - 1;
+  if (key - front_key < back_key - key) {
+    std::ptrdiff_t step = 1;
+    while (step < hi && proj(first[step]) < key) {
+      lo = step;
+      step *= 2;
+    }
+    hi = std::min(step, hi);
+  } else {
+    std::ptrdiff_t step = 1;
+    while (step < n - 1 && proj(first[n - 1 - step]) >= key) {
+      hi = n - 1 - step;
+      step *= 2;
+    }
+    lo = std::max<std::ptrdiff_t>(n - 1 - step, 0);
+  }
+  return std::partition_point(first + lo + 1, first + hi + 1,
+                              [&](const auto& value) { return proj(value) < key; });
+}
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "order.hpp"
+#include "vec_deque.hpp"
+
+// The Order fields that id searches and volume walks read, plus the slot of the order's cold
+// half where the container needs one. The slot sits in what would otherwise be padding, so a
+// HotOrder is 16 bytes against Order's 24.
+struct HotOrder {
+  std::uint64_t id{};
+  std::int32_t volume{};
+  std::uint32_t cold{};
+};
+
+static_assert(sizeof(HotOrder) == 16);
+
+// The Order fields that only whole-order consumers need.
+struct ColdOrder {
+  std::uint64_t exchangeTimestamp{};
+  bool isOwn{};
+};
+
+// Stores orders split in two: HotContainer (a std::vector, VecDeque or VolumeBreakdown of
+// HotOrder) keeps its usual layout and operations over the hot halves. For the positional
+// containers (vector, VecDeque) the cold halves live in a parallel container of the same shape,
+// in hot order, and every push, pop and erase is mirrored at the same position, so orders()
+// streams both arrays in step. VolumeBreakdown has no positions, and an O(n) cold shift per
+// erase would undo its O(block) erase, so there the cold halves live in a side array addressed
+// by each HotOrder's slot instead. The slot travels with the hot half however the blocks shift
+// it; freed slots are reused, and the array is dropped whenever the container empties. After
+// churn the slots are no longer in hot order, so orders() gathers cold halves at random.
+//
+// Iteration yields the hot halves read-only, so searches and volume walks never touch cold
+// memory; orders() joins the halves back into whole Orders.
+template <typename HotContainer>
+class HotColdSplit {
+  static_assert(std::is_same_v<typename HotContainer::value_type, HotOrder>,
+                "HotColdSplit stores HotOrder elements");
+
+ public:
+  // Whether the cold halves are kept in hot order rather than addressed by slot.
+  static constexpr bool kInHotOrder = requires(const HotContainer& hot) { hot[std::size_t{}]; };
+  using ColdContainer =
+      std::conditional_t<kInHotOrder && requires(HotContainer& hot) { hot.pop_front(); },
+                         VecDeque<ColdOrder>,
+                         std::vector<ColdOrder>>;
+
+  using value_type = HotOrder;
+  using size_type = std::size_t;
+  using const_iterator = typename HotContainer::const_iterator;
+  using iterator = const_iterator;
+
+  // Yields whole Orders by value, joined from the hot iterator and its cold slot.
+  class order_iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Order;
+    using difference_type = std::ptrdiff_t;
+    using reference = Order;
+    using pointer = void;
+
+    order_iterator() = default;
+    order_iterator(const HotColdSplit* owner, const_iterator it) : owner_(owner), it_(it) {}
+
+    Order operator*() const { return owner_->order(it_); }
+
+    order_iterator& operator++() {
+      ++it_;
+      return *this;
+    }
+    order_iterator operator++(int) {
+      order_iterator tmp = *this;
+      ++it_;
+      return tmp;
+    }
+
+    const_iterator base() const { return it_; }
+
+    friend bool operator==(const order_iterator& a, const order_iterator& b) {
+      return a.it_ == b.it_;
+    }
+    friend bool operator!=(const order_iterator& a, const order_iterator& b) { return !(a == b); }
+
+   private:
+    const HotColdSplit* owner_{nullptr};
+    const_iterator it_{};
+  };
+
+  struct OrderView {
+    order_iterator first;
+    order_iterator last;
+    order_iterator begin() const { return first; }
+    order_iterator end() const { return last; }
+  };
+
+  HotColdSplit() = default;
+
+  bool empty() const { return hot_.empty(); }
+  size_type size() const { return hot_.size(); }
+
+  const HotOrder& front() const { return hot_.front(); }
+  const HotOrder& back() const { return hot_.back(); }
+
+  const_iterator begin() const { return hot_.begin(); }
+  const_iterator end() const { return hot_.end(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  const HotContainer& hot() const { return hot_; }
+  const ColdOrder& cold(const_iterator it) const {
+    if constexpr (kInHotOrder) {
+      return cold_[static_cast<size_type>(it - begin())];
+    } else {
+      return cold_[it->cold];
+    }
+  }
+
+  Order order(const_iterator it) const {
+    const ColdOrder& rest = cold(it);
+    return Order{it->id, rest.exchangeTimestamp, it->volume, rest.isOwn};
+  }
+
+  OrderView orders() const { return {{this, begin()}, {this, end()}}; }
+
+  void clear() {
+    hot_.clear();
+    cold_.clear();
+    free_slots_.clear();
+  }
+
+  void push_back(const Order& order) {
+    if constexpr (kInHotOrder) {
+      cold_.push_back(ColdOrder{order.exchangeTimestamp, order.isOwn});
+      hot_.push_back(HotOrder{order.id, order.volume, 0});
+    } else {
+      hot_.push_back(HotOrder{order.id, order.volume, acquire(order)});
+    }
+  }
+
+  void pop_front() {
+    assert(!empty());
+    if constexpr (kInHotOrder) {
+      pop_front_of(cold_);
+    } else {
+      release(hot_.front().cold);
+    }
+    pop_front_of(hot_);
+    drop_cold_if_empty();
+  }
+
+  void pop_back() {
+    assert(!empty());
+    if constexpr (kInHotOrder) {
+      cold_.pop_back();
+    } else {
+      release(hot_.back().cold);
+    }
+    hot_.pop_back();
+    drop_cold_if_empty();
+  }
+
+  const_iterator erase(const_iterator pos) {
+    if (pos == end()) {
+      return end();
+    }
+    const_iterator next;
+    if constexpr (kInHotOrder) {
+      const auto index = pos - hot_.cbegin();
+      cold_.erase(cold_.begin() + index);
+      next = hot_.erase(hot_.begin() + index);
+    } else {
+      release(pos->cold);
+      next = hot_.erase(pos);
+    }
+    drop_cold_if_empty();
+    return next;
+  }
+
+  // Range erase for hot containers that have one (std::vector), so front batches shift once.
+  const_iterator erase(const_iterator first, const_iterator last)
+    requires requires(HotContainer& hot) { hot.erase(first, last); }
+  {
+    if constexpr (kInHotOrder) {
+      const auto cold_first = cold_.begin() + (first - hot_.cbegin());
+      cold_.erase(cold_first, cold_first + (last - first));
+    } else {
+      for (auto it = first; it != last; ++it) {
+        release(it->cold);
+      }
+    }
+    const_iterator next = hot_.erase(first, last);
+    drop_cold_if_empty();
+    return next;
+  }
+
+  bool erase_by_id(std::uint64_t id) {
+    const const_iterator it = find(id);
+    if (it == end()) {
+      return false;
+    }
+    erase(it);
+    return true;
+  }
+
+  // The hot half with `id`, or end(): the container's own id lookup where it has one, a
+  // binary search over the sorted hot halves otherwise.
+  const_iterator find(std::uint64_t id) const {
+    if constexpr (requires { hot_.find(id); }) {
+      return hot_.find(id);
+    } else {
+      const auto it = std::lower_bound(
+          begin(), end(), id, [](const HotOrder& hot, std::uint64_t key) { return hot.id < key; });
+      return it != end() && it->id == id ? it : end();
+    }
+  }
+
+  // Changes the volume of order `id` in place: through the container's own set_volume_by_id
+  // where it has one, which keeps its totals exact, and in the hot half otherwise.
+  bool set_volume_by_id(std::uint64_t id, std::int64_t volume) {
+    if constexpr (requires { hot_.set_volume_by_id(id, volume); }) {
+      return hot_.set_volume_by_id(id, volume);
+    } else {
+      const const_iterator it = find(id);
+      if (it == end()) {
+        return false;
+      }
+      hot_[static_cast<std::size_t>(it - begin())].volume = static_cast<std::int32_t>(volume);
+      return true;
+    }
+  }
+
+  const_iterator lower_bound_by_id(std::uint64_t id) const
+    requires requires(const HotContainer& hot) { hot.lower_bound_by_id(id); }
+  {
+    return hot_.lower_bound_by_id(id);
+  }
+
+  auto volume_range(std::int64_t lower, std::int64_t upper) const
+    requires requires(const HotContainer& hot) { hot.volume_range(lower, upper); }
+  {
+    return hot_.volume_range(lower, upper);
+  }
+
+  auto volume_cursor()
+    requires requires(HotContainer& hot) { hot.volume_cursor(); }
+  {
+    return hot_.volume_cursor();
+  }
+
+  template <typename Cursor>
+  auto volume_range(Cursor& cursor, std::int64_t lower, std::int64_t upper) const
+    requires requires(const HotContainer& hot) { hot.volume_range(cursor, lower, upper); }
+  {
+    return hot_.volume_range(cursor, lower, upper);
+  }
+
+ private:
+  template <typename Container>
+  static void pop_front_of(Container& container) {
+    if constexpr (requires { container.pop_front(); }) {
+      container.pop_front();
+    } else {
+      container.erase(container.begin());
+    }
+  }
+
+  std::uint32_t acquire(const Order& order) {
+    const ColdOrder rest{order.exchangeTimestamp, order.isOwn};
+    if (!free_slots_.empty()) {
+      const std::uint32_t slot = free_slots_.back();
+      free_slots_.pop_back();
+      cold_[slot] = rest;
+      return slot;
+    }
+    assert(cold_.size() < std::numeric_limits<std::uint32_t>::max());
+    cold_.push_back(rest);
+    return static_cast<std::uint32_t>(cold_.size() - 1);
+  }
+
+  void release(std::uint32_t slot) { free_slots_.push_back(slot); }
+
+  void drop_cold_if_empty() {
+    if (hot_.empty()) {
+      cold_.clear();
+      free_slots_.clear();
+    }
+  }
+
+  HotContainer hot_;
+  ColdContainer cold_;
+  std::vector<std::uint32_t> free_slots_;
+};
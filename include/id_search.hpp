@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "order.hpp"
+
+// Static id-search engines built from a sorted, contiguous run of orders. Every engine answers
+// `lower_bound(id)` with the index (into the source span) of the first order whose id is not
+// less than `id`, or `size()` when there is none, so they are interchangeable in benchmarks.
+
+namespace id_search_detail {
+
+constexpr std::size_t kCacheLine = 64;
+constexpr std::size_t kKeysPerLine = kCacheLine / sizeof(std::uint64_t);
+
+struct AlignedDelete {
+  void operator()(std::uint64_t* ptr) const {
+    ::operator delete[](ptr, std::align_val_t{kCacheLine});
+  }
+};
+
+using AlignedKeys = std::unique_ptr<std::uint64_t[], AlignedDelete>;
+
+inline AlignedKeys make_aligned_keys(std::size_t count) {
+  void* raw = ::operator new[](count * sizeof(std::uint64_t), std::align_val_t{kCacheLine});
+  return AlignedKeys(static_cast<std::uint64_t*>(raw));
+}
+
+}  // namespace id_search_detail
+
+// Reference engine: std::lower_bound over a packed id array.
+class StdIdSearch {
+ public:
+  explicit StdIdSearch(std::span<const Order> orders) : ids_(orders.size()) {
+    std::transform(orders.begin(), orders.end(), ids_.begin(),
+                   [](const Order& order) { return order.id; });
+  }
+
+  std::size_t size() const { return ids_.size(); }
+  std::size_t memory_bytes() const {
+    return sizeof(*this) + ids_.capacity() * sizeof(std::uint64_t);
+  }
+
+  std::size_t lower_bound(std::uint64_t id) const {
+    return static_cast<std::size_t>(std::lower_bound(ids_.begin(), ids_.end(), id) -
+                                    ids_.begin());
+  }
+
+ private:
+  std::vector<std::uint64_t> ids_;
+};
+
+// Binary search whose loop body is a conditional move rather than a branch: the trip count
+// depends only on the size, so there is nothing to mispredict. Both candidate midpoints of the
+// next step are prefetched, since the cmove no longer lets the CPU speculate into one of them.
+class BranchlessIdSearch {
+ public:
+  explicit BranchlessIdSearch(std::span<const Order> orders) : ids_(orders.size()) {
+    std::transform(orders.begin(), orders.end(), ids_.begin(),
+                   [](const Order& order) { return order.id; });
+  }
+
+  std::size_t size() const { return ids_.size(); }
+  std::size_t memory_bytes() const {
+    return sizeof(*this) + ids_.capacity() * sizeof(std::uint64_t);
+  }
+
+  std::size_t lower_bound(std::uint64_t id) const {
+    std::size_t len = ids_.size();
+    if (len == 0) {
+      return 0;
+    }
+    const std::uint64_t* base = ids_.data();
+    while (len > 1) {
+      const std::size_t half = len / 2;
+      __builtin_prefetch(base + len / 4);
+      __builtin_prefetch(base + half + len / 4);
+      base = (base[half] < id) ? base + half : base;
+      len -= half;
+    }
+    return static_cast<std::size_t>(base - ids_.data()) + (*base < id);
+  }
+
+ private:
+  std::vector<std::uint64_t> ids_;
+};
+
+// Ids in BFS (Eytzinger) order: node k has children 2k and 2k + 1, so the first levels of every
+// search share a handful of cache lines. Each step prefetches the line holding the node's
+// descendants three levels down, overlapping those misses with the current comparisons.
+class EytzingerIdSearch {
+ public:
+  explicit EytzingerIdSearch(std::span<const Order> orders)
+      : size_(orders.size()),
+        keys_(id_search_detail::make_aligned_keys(orders.size() + 1)),
+        ranks_(orders.size() + 1) {
+    std::size_t next = 0;
+    build(orders, 1, next);
+    keys_[0] = 0;
+    ranks_[0] = size_;
+  }
+
+  std::size_t size() const { return size_; }
+  std::size_t memory_bytes() const {
+    return sizeof(*this) + (size_ + 1) * (sizeof(std::uint64_t) + sizeof(std::size_t));
+  }
+
+  std::size_t lower_bound(std::uint64_t id) const {
+    std::size_t k = 1;
+    while (k <= size_) {
+      __builtin_prefetch(keys_.get() + k * id_search_detail::kKeysPerLine);
+      k = 2 * k + (keys_[k] < id);
+    }
+    // Undo the trailing right turns plus the final left turn to land on the answer node.
+    k >>= std::countr_one(k) + 1;
+    return ranks_[k];
+  }
+
+ private:
+  void build(std::span<const Order> orders, std::size_t k, std::size_t& next) {
+    if (k > size_) {
+      return;
+    }
+    build(orders, 2 * k, next);
+    keys_[k] = orders[next].id;
+    ranks_[k] = next++;
+    build(orders, 2 * k + 1, next);
+  }
+
+  std::size_t size_;
+  id_search_detail::AlignedKeys keys_;
+  std::vector<std::size_t> ranks_;
+};
+
+// Static B-tree with one cache line (eight ids) per node and nine children per node, laid out
+// implicitly: node k's i-th child is k * 9 + i + 1. A lookup touches one line per level, about
+// log9(n) lines instead of log2(n). Unused slots are padded with the maximum id.
+class BTreeIdSearch {
+  static constexpr std::size_t kB = id_search_detail::kKeysPerLine;
+
+ public:
+  explicit BTreeIdSearch(std::span<const Order> orders)
+      : size_(orders.size()),
+        node_count_((orders.size() + kB - 1) / kB),
+        keys_(id_search_detail::make_aligned_keys(node_count_ * kB)),
+        ranks_(node_count_ * kB) {
+    std::size_t next = 0;
+    build(orders, 0, next);
+  }
+
+  std::size_t size() const { return size_; }
+  std::size_t memory_bytes() const {
+    return sizeof(*this) + node_count_ * kB * (sizeof(std::uint64_t) + sizeof(std::size_t));
+  }
+
+  std::size_t lower_bound(std::uint64_t id) const {
+    std::size_t result = size_;
+    std::size_t k = 0;
+    while (k < node_count_) {
+      const std::uint64_t* node = keys_.get() + k * kB;
+      std::size_t i = 0;
+      for (std::size_t j = 0; j < kB; ++j) {
+        i += node[j] < id;
+      }
+      if (i < kB) {
+        result = ranks_[k * kB + i];
+      }
+      k = child(k, i);
+    }
+    return result;
+  }
+
+ private:
+  static constexpr std::size_t child(std::size_t k, std::size_t i) { return k * (kB + 1) + i + 1; }
+
+  void build(std::span<const Order> orders, std::size_t k, std::size_t& next) {
+    if (k >= node_count_) {
+      return;
+    }
+    for (std::size_t i = 0; i < kB; ++i) {
+      build(orders, child(k, i), next);
+      if (next < size_) {
+        keys_[k * kB + i] = orders[next].id;
+        ranks_[k * kB + i] = next++;
+      } else {
+        keys_[k * kB + i] = std::numeric_limits<std::uint64_t>::max();
+        ranks_[k * kB + i] = size_;
+      }
+    }
+    build(orders, child(k, kB), next);
+  }
+
+  std::size_t size_;
+  std::size_t node_count_;
+  id_search_detail::AlignedKeys keys_;
+  std::vector<std::size_t> ranks_;
+};
+
+// Hashed id -> index map, the exact-match baseline for the ordered engines. It cannot answer a
+// lower bound: ids that are not present return size().
+class HashIdSearch {
+ public:
+  explicit HashIdSearch(std::span<const Order> orders) : size_(orders.size()) {
+    positions_.reserve(orders.size());
+    for (std::size_t i = 0; i < orders.size(); ++i) {
+      positions_.emplace(orders[i].id, static_cast<std::uint32_t>(i));
+    }
+  }
+
+  std::size_t size() const { return size_; }
+  // absl's Swiss table keeps one control byte per slot next to the slot array.
+  std::size_t memory_bytes() const {
+    return sizeof(*this) +
+           positions_.capacity() * (sizeof(std::pair<const std::uint64_t, std::uint32_t>) + 1);
+  }
+
+  std::size_t lower_bound(std::uint64_t id) const {
+    const auto it = positions_.find(id);
+    return it == positions_.end() ? size_ : it->second;
+  }
+
+ private:
+  std::size_t size_;
+  absl::flat_hash_map<std::uint64_t, std::uint32_t> positions_;
+};
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+// Key -> Value index for keys that stay inside a sliding window [lo, hi] with small gaps, such
+// as live order ids. Values sit in a power-of-two ring indexed by `key & mask`, so a lookup is a
+// range check plus one array load, and memory is sizeof(Value) per key in the window. Slots
+// without a live key hold `Empty`, which is also what `find` returns for absent keys.
+//
+// `lo` and `hi` track the lowest and highest live keys (erasing either end scans inward to the
+// next live slot). When a key would stretch the window beyond kMaxSlotsPerKey slots per live
+// key, the index moves its entries into a hash map. While hashed it re-measures the span of its
+// keys after every size() erases (amortised O(1) per erase) and moves back into a direct
+// window once the keys fit in half the slots that would have forced the switch, so one old
+// key that is finally erased does not leave the index hashed for good.
+template <typename Value, Value Empty, typename Allocator = std::allocator<Value>>
+class IdWindowIndex {
+  using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Value>;
+  using FallbackAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<
+      std::pair<const std::uint64_t, Value>>;
+  using FallbackMap = absl::flat_hash_map<std::uint64_t, Value, absl::Hash<std::uint64_t>,
+                                          std::equal_to<std::uint64_t>, FallbackAllocator>;
+
+ public:
+  static constexpr std::size_t kMinCapacity = 64;
+  static constexpr std::size_t kMaxSlotsPerKey = 16;
+
+  IdWindowIndex() = default;
+  explicit IdWindowIndex(const Allocator& alloc)
+      : slots_(SlotAllocator(alloc)), fallback_(FallbackAllocator(alloc)) {}
+
+  IdWindowIndex(IdWindowIndex&& other) noexcept
+      : slots_(std::move(other.slots_)),
+        mask_(other.mask_),
+        lo_(other.lo_),
+        hi_(other.hi_),
+        size_(other.size_),
+        hashed_(other.hashed_),
+        erases_since_check_(other.erases_since_check_),
+        fallback_(std::move(other.fallback_)) {
+    other.reset();
+  }
+
+  IdWindowIndex& operator=(IdWindowIndex&& other) {
+    if (this != &other) {
+      slots_ = std::move(other.slots_);
+      mask_ = other.mask_;
+      lo_ = other.lo_;
+      hi_ = other.hi_;
+      size_ = other.size_;
+      hashed_ = other.hashed_;
+      erases_since_check_ = other.erases_since_check_;
+      fallback_ = std::move(other.fallback_);
+      other.reset();
+    }
+    return *this;
+  }
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool direct() const { return !hashed_; }
+
+  Value find(std::uint64_t key) const {
+    if (hashed_) {
+      const auto it = fallback_.find(key);
+      return it == fallback_.end() ? Empty : it->second;
+    }
+    if (size_ == 0 || key < lo_ || key > hi_) {
+      return Empty;
+    }
+    return slots_[key & mask_];
+  }
+
+  // Starts loading the slot (or hash group) `find(key)` will read.
+  void prefetch(std::uint64_t key) const {
+    if (hashed_) {
+      fallback_.prefetch(key);
+    } else if (size_ != 0 && key >= lo_ && key <= hi_) {
+      __builtin_prefetch(slots_.data() + (key & mask_));
+    }
+  }
+
+  void insert_or_assign(std::uint64_t key, Value value) {
+    assert(value != Empty);
+    if (hashed_) {
+      size_ += fallback_.insert_or_assign(key, value).second ? 1 : 0;
+      return;
+    }
+    if (size_ == 0) {
+      if (slots_.empty()) {
+        reallocate(kMinCapacity);
+      }
+      lo_ = hi_ = key;
+    } else if (key < lo_ || key > hi_) {
+      const std::uint64_t new_lo = key < lo_ ? key : lo_;
+      const std::uint64_t new_hi = key > hi_ ? key : hi_;
+      const std::uint64_t span = new_hi - new_lo + 1;
+      if (span > slots_.size()) {
+        if (span > std::max<std::uint64_t>(kMinCapacity, kMaxSlotsPerKey * (size_ + 1))) {
+          switch_to_fallback();
+          insert_or_assign(key, value);
+          return;
+        }
+        reallocate(static_cast<std::size_t>(std::bit_ceil(span)));
+      }
+      lo_ = new_lo;
+      hi_ = new_hi;
+    }
+    Value& slot = slots_[key & mask_];
+    size_ += slot == Empty ? 1 : 0;
+    slot = value;
+  }
+
+  void erase(std::uint64_t key) {
+    if (hashed_) {
+      size_ -= fallback_.erase(key);
+      if (size_ == 0) {
+        clear();
+      } else if (++erases_since_check_ >= size_) {
+        leave_fallback_if_dense();
+      }
+      return;
+    }
+    if (size_ == 0 || key < lo_ || key > hi_) {
+      return;
+    }
+    Value& slot = slots_[key & mask_];
+    if (slot == Empty) {
+      return;
+    }
+    slot = Empty;
+    if (--size_ == 0) {
+      return;
+    }
+    while (slots_[lo_ & mask_] == Empty) {
+      ++lo_;
+    }
+    while (slots_[hi_ & mask_] == Empty) {
+      --hi_;
+    }
+  }
+
+  void clear() {
+    if (!hashed_) {
+      for (std::uint64_t key = lo_; size_ > 0 && key <= hi_; ++key) {
+        slots_[key & mask_] = Empty;
+      }
+    }
+    fallback_.clear();
+    hashed_ = false;
+    erases_since_check_ = 0;
+    size_ = 0;
+    lo_ = hi_ = 0;
+  }
+
+ private:
+  // Leaves a moved-from index empty; its slots may have been copied rather than stolen.
+  void reset() {
+    slots_.clear();
+    fallback_.clear();
+    mask_ = lo_ = hi_ = 0;
+    size_ = 0;
+    hashed_ = false;
+    erases_since_check_ = 0;
+  }
+
+  // Re-lays the live window [lo_, hi_] into a ring of `capacity` slots.
+  void reallocate(std::size_t capacity) {
+    std::vector<Value, SlotAllocator> next(capacity, Empty, slots_.get_allocator());
+    const std::uint64_t next_mask = capacity - 1;
+    for (std::uint64_t key = lo_; size_ > 0 && key <= hi_; ++key) {
+      next[key & next_mask] = slots_[key & mask_];
+    }
+    slots_ = std::move(next);
+    mask_ = next_mask;
+  }
+
+  void switch_to_fallback() {
+    fallback_.reserve(size_ + 1);
+    for (std::uint64_t key = lo_; key <= hi_; ++key) {
+      Value& slot = slots_[key & mask_];
+      if (slot != Empty) {
+        fallback_.emplace(key, slot);
+        slot = Empty;
+      }
+    }
+    hashed_ = true;
+    erases_since_check_ = 0;
+  }
+
+  void leave_fallback_if_dense() {
+    erases_since_check_ = 0;
+    std::uint64_t lo = fallback_.begin()->first;
+    std::uint64_t hi = lo;
+    for (const auto& entry : fallback_) {
+      lo = std::min(lo, entry.first);
+      hi = std::max(hi, entry.first);
+    }
+    const std::uint64_t span = hi - lo + 1;
+    if (2 * span > std::max<std::uint64_t>(kMinCapacity, kMaxSlotsPerKey * size_)) {
+      return;
+    }
+    // switch_to_fallback left every slot Empty, so the ring only needs resizing.
+    const std::size_t capacity =
+        static_cast<std::size_t>(std::bit_ceil(std::max<std::uint64_t>(span, kMinCapacity)));
+    if (capacity != slots_.size()) {
+      slots_.assign(capacity, Empty);
+      mask_ = capacity - 1;
+    }
+    for (const auto& [key, value] : fallback_) {
+      slots_[key & mask_] = value;
+    }
+    fallback_.clear();
+    lo_ = lo;
+    hi_ = hi;
+    hashed_ = false;
+  }
+
+  std::vector<Value, SlotAllocator> slots_;
+  std::uint64_t mask_{0};
+  std::uint64_t lo_{0};
+  std::uint64_t hi_{0};
+  std::size_t size_{0};
+  bool hashed_{false};
+  std::size_t erases_since_check_{0};
+  FallbackMap fallback_;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+// lower_bound over a range sorted by an unsigned 64-bit key, for keys that are close to evenly
+// spaced (order ids advance by 1-4 per order). Each round probes the position predicted by
+// linear interpolation between the tightest known bounds, then a guard kInterpolationGuard
+// slots further in the same direction to try to close the bracket from the other side. On dense
+// keys the answer is usually bracketed within a few elements after one or two rounds. Once the
+// bracket is small, or after kMaxInterpolationRounds on badly skewed keys, it finishes with a
+// plain binary search inside the bracket, so the worst case stays O(log n).
+inline constexpr int kMaxInterpolationRounds = 4;
+inline constexpr std::ptrdiff_t kInterpolationGuard = 8;
+inline constexpr std::ptrdiff_t kInterpolationFinishSpan = 16;
+
+template <typename RandomIt, typename Projection>
+RandomIt interpolation_lower_bound(RandomIt first,
+                                   RandomIt last,
+                                   std::uint64_t key,
+                                   Projection proj) {
+  assert(std::is_sorted(first, last,
+                        [&](const auto& a, const auto& b) { return proj(a) < proj(b); }));
+  const auto n = std::distance(first, last);
+  if (n == 0) {
+    return first;
+  }
+  std::uint64_t lo_key = proj(first[0]);
+  if (key <= lo_key) {
+    return first;
+  }
+  std::uint64_t hi_key = proj(first[n - 1]);
+  if (key > hi_key) {
+    return last;
+  }
+  // Invariant: proj(first[lo]) < key <= proj(first[hi]), so the answer lies in (lo, hi].
+  std::ptrdiff_t lo = 0;
+  std::ptrdiff_t hi = n - 1;
+  const auto narrow = [&](std::ptrdiff_t pos) {
+    const std::uint64_t pos_key = proj(first[pos]);
+    if (pos_key < key) {
+      lo = pos;
+      lo_key = pos_key;
+      return true;
+    }
+    hi = pos;
+    hi_key = pos_key;
+    return false;
+  };
+  for (int round = 0; round < kMaxInterpolationRounds && hi - lo > kInterpolationFinishSpan;
+       ++round) {
+    const double fraction =
+        static_cast<double>(key - lo_key) / static_cast<double>(hi_key - lo_key);
+    const auto offset = static_cast<std::ptrdiff_t>(fraction * static_cast<double>(hi - lo));
+    const std::ptrdiff_t probe = lo + std::clamp<std::ptrdiff_t>(offset, 1, hi - lo - 1);
+    if (narrow(probe)) {
+      if (probe + kInterpolationGuard < hi) {
+        narrow(probe + kInterpolationGuard);
+      }
+    } else if (probe - kInterpolationGuard > lo) {
+      narrow(probe - kInterpolationGuard);
+    }
+  }
+  return std::partition_point(first + lo + 1, first + hi + 1,
+                              [&](const auto& value) { return proj(value) < key; });
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Allocator for VecDeque that backs large power-of-two rings with the same memfd pages mapped
+// twice back to back, so [data, data + 2 * n) is valid and slot i + n aliases slot i. A ring in
+// such a buffer never needs wrap handling: every logical range is one contiguous span.
+//
+// Mirroring is used only when the buffer is at least kMinMirrorBytes and a whole number of
+// pages; smaller requests (and non-Linux builds) fall back to std::allocator. VecDeque detects
+// the `mirrors_ring` marker and asks `is_mirrored(n)` which layout a capacity got.
+template <typename T>
+class MirroredAllocator {
+ public:
+  using value_type = T;
+  static constexpr bool mirrors_ring = true;
+  static constexpr std::size_t kMinMirrorBytes = 64 * 1024;
+
+  MirroredAllocator() = default;
+  template <typename U>
+  MirroredAllocator(const MirroredAllocator<U>&) {}
+
+  static bool is_mirrored(std::size_t n) {
+#if defined(__linux__)
+    const std::size_t bytes = n * sizeof(T);
+    return bytes >= kMinMirrorBytes && bytes % page_size() == 0;
+#else
+    (void)n;
+    return false;
+#endif
+  }
+
+  T* allocate(std::size_t n) {
+    if (!is_mirrored(n)) {
+      return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T*>(map_mirrored(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, std::size_t n) {
+    if (!is_mirrored(n)) {
+      std::allocator<T>().deallocate(ptr, n);
+      return;
+    }
+#if defined(__linux__)
+    ::munmap(ptr, 2 * n * sizeof(T));
+#endif
+  }
+
+  template <typename U>
+  bool operator==(const MirroredAllocator<U>&) const {
+    return true;
+  }
+
+ private:
+#if defined(__linux__)
+  static std::size_t page_size() {
+    static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+  }
+
+  static void* map_mirrored(std::size_t bytes) {
+    const int fd = ::memfd_create("vec_deque_ring", MFD_CLOEXEC);
+    if (fd < 0) {
+      throw std::bad_alloc();
+    }
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+      ::close(fd);
+      throw std::bad_alloc();
+    }
+    // Reserve both halves first so the two fixed mappings cannot land on anything else.
+    void* reserved = ::mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+      ::close(fd);
+      throw std::bad_alloc();
+    }
+    auto* base = static_cast<std::byte*>(reserved);
+    const int prot = PROT_READ | PROT_WRITE;
+    const bool mapped =
+        ::mmap(base, bytes, prot, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+        ::mmap(base + bytes, bytes, prot, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+    ::close(fd);
+    if (!mapped) {
+      ::munmap(reserved, 2 * bytes);
+      throw std::bad_alloc();
+    }
+    return base;
+  }
+#else
+  static void* map_mirrored(std::size_t) { throw std::bad_alloc(); }
+#endif
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "order.hpp"
+#include "order_generator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// One change to a single price level's queue, in arrival order.
+struct OrderFlowEvent {
+  enum class Kind : std::uint8_t {
+    Add,         // `order` joins the back
+    Cancel,      // order `id` leaves
+    ModifyDown,  // order `id` shrinks to `volume` and keeps its place
+    ModifyUp,    // order `id` leaves and `order`, its grown replacement, joins the back
+    Execute,     // the front order, `id`, trades `volume`; it leaves if that is all of it
+  };
+
+  Kind kind{Kind::Add};
+  std::uint64_t timestamp{};
+  std::uint64_t id{};
+  std::int32_t volume{};
+  Order order{};
+};
+
+struct OrderFlowConfig {
+  enum class Position {
+    Uniform,       // every live order equally likely
+    PositionZipf,  // queue position p (0 = front) with weight 1 / (p + 1)^exponent
+    Recent,        // the order `age` places from the back, `age` geometric of mean mean_age
+  };
+  enum class Arrival {
+    Poisson,  // exponential gaps of mean mean_gap_ns
+    Bursty,   // Poisson, switching into bursts whose gaps are burst_speedup times shorter
+  };
+
+  // Relative event rates while the queue holds target_size orders. The add rate is scaled by
+  // target_size / size, clamped to [1/4, 4], so the queue drifts back towards the target.
+  double add_rate{0.40};
+  double cancel_rate{0.30};
+  double modify_down_rate{0.10};
+  double modify_up_rate{0.05};
+  double execute_rate{0.15};
+  std::size_t target_size{1'000};
+
+  // Which orders cancels and modifies hit.
+  Position cancel_position{Position::Recent};
+  double exponent{1.1};
+  double mean_age{64.0};
+
+  // Executions trade a uniform volume in [1, max_execute_volume], capped by the front order.
+  std::int32_t max_execute_volume{2'000};
+
+  Arrival arrival{Arrival::Poisson};
+  double mean_gap_ns{1'000.0};
+  // Per-event chance of a burst starting, and its mean length in events.
+  double burst_start{0.01};
+  double mean_burst_events{100.0};
+  double burst_speedup{20.0};
+};
+
+// Deterministic event stream over one queue, starting from `book` (sorted by id). New orders
+// come from an OrderGenerator with their ids shifted above the book's last id, so the queue
+// stays sorted by id however it is cancelled. Every event targets a live order; the
+// generator tracks the live orders with a Fenwick tree over slots, so picking the order at
+// any queue position costs O(log n) rather than an erase from the middle of an array.
+class OrderFlowGenerator {
+ public:
+  OrderFlowGenerator(const OrderFlowConfig& config,
+                     std::uint64_t seed,
+                     std::span<const Order> book = {});
+
+  OrderFlowEvent next_event();
+  std::vector<OrderFlowEvent> generate(std::size_t count);
+
+  // Live orders after the events generated so far.
+  std::size_t size() const { return live_; }
+
+ private:
+  struct Slot {
+    std::uint64_t id;
+    std::int32_t volume;  // 0 once the order has left
+  };
+
+  void push_slot(std::uint64_t id, std::int32_t volume);
+  void kill_slot(std::size_t slot);
+  // Slot of the live order at queue position `position`.
+  std::size_t slot_at(std::size_t position) const;
+  // Drops dead slots and rebuilds the tree with room for at least `capacity` slots.
+  void rebuild(std::size_t capacity);
+
+  std::size_t pick_position();
+  OrderFlowEvent::Kind pick_kind();
+  std::uint64_t next_timestamp();
+  Order new_order(std::int32_t volume);
+
+  OrderFlowConfig config_;
+  OrderGenerator generator_;
+  std::mt19937_64 rng_;
+  std::vector<Slot> slots_;
+  // Fenwick tree of live counts over slots_, sized to a power of two.
+  std::vector<std::uint32_t> tree_;
+  std::size_t live_{0};
+  std::uint64_t id_base_{0};
+  std::uint64_t now_{0};
+  bool bursting_{false};
+};
+
+namespace order_flow_detail {
+
+template <typename Container>
+auto lower_bound_id(Container& container, std::uint64_t id) {
+  if constexpr (requires { container.lower_bound_by_id(id); }) {
+    return container.lower_bound_by_id(id);
+  } else {
+    return std::lower_bound(container.begin(), container.end(), id,
+                            [](const auto& order, std::uint64_t key) { return order.id < key; });
+  }
+}
+
+template <typename Container>
+void erase_id(Container& container, std::uint64_t id) {
+  if constexpr (requires { container.erase_by_id(id); }) {
+    container.erase_by_id(id);
+  } else {
+    const auto it = lower_bound_id(container, id);
+    if (it != container.end() && it->id == id) {
+      container.erase(it);
+    }
+  }
+}
+
+// Containers that derive state from the volumes (block totals, prefix sums) must change them
+// through set_volume_by_id or set_volume; only plain Order queues are written in place.
+template <typename Container>
+void set_volume(Container& container, std::uint64_t id, std::int64_t volume) {
+  if constexpr (requires { container.set_volume_by_id(id, volume); }) {
+    container.set_volume_by_id(id, volume);
+  } else if constexpr (requires { container.set_volume(container.begin(), volume); }) {
+    const auto it = lower_bound_id(container, id);
+    if (it != container.end() && it->id == id) {
+      container.set_volume(it, volume);
+    }
+  } else {
+    static_assert(std::is_same_v<typename Container::value_type, Order>,
+                  "set_volume writes Order volumes in place");
+    static_assert(!requires { container.total_volume(); },
+                  "containers that keep volume totals need set_volume_by_id or set_volume");
+    const auto it = lower_bound_id(container, id);
+    if (it != container.end() && it->id == id) {
+      it->volume = static_cast<std::int32_t>(volume);
+    }
+  }
+}
+
+template <typename Container>
+void pop_front(Container& container) {
+  if constexpr (requires { container.pop_front(); }) {
+    container.pop_front();
+  } else {
+    container.erase(container.begin());
+  }
+}
+
+}  // namespace order_flow_detail
+
+// Applies `event` to a container of Orders kept in queue order, which the stream keeps in id
+// order too: std::vector, std::deque, VecDeque (mirrored or not), CumulativeVecDeque,
+// VolumeBreakdown or a HotColdSplit. Cancels use erase_by_id and modify-downs
+// set_volume_by_id where the container has them, and an id search plus an erase or a volume
+// change otherwise. Compact books hold id offsets rather than the stream's ids.
+template <typename Container>
+void apply_order_flow(Container& container, const OrderFlowEvent& event) {
+  using Kind = OrderFlowEvent::Kind;
+  switch (event.kind) {
+    case Kind::Add:
+      container.push_back(event.order);
+      break;
+    case Kind::Cancel:
+      order_flow_detail::erase_id(container, event.id);
+      break;
+    case Kind::ModifyDown:
+      order_flow_detail::set_volume(container, event.id, event.volume);
+      break;
+    case Kind::ModifyUp:
+      order_flow_detail::erase_id(container, event.id);
+      container.push_back(event.order);
+      break;
+    case Kind::Execute:
+      if (container.empty()) {
+        break;
+      }
+      if (event.volume >= container.front().volume) {
+        order_flow_detail::pop_front(container);
+      } else {
+        order_flow_detail::set_volume(container, event.id,
+                                      container.front().volume - event.volume);
+      }
+      break;
+  }
+}
+
+template <typename Container>
+void apply_order_flow(Container& container, std::span<const OrderFlowEvent> events) {
+  for (const OrderFlowEvent& event : events) {
+    apply_order_flow(container, event);
+  }
+}
@@ -7,6 +7,13 @@
 #include <random>
 #include <vector>
 
+// Deterministic order source. Order i of a seed is drawn from one 64-bit SplitMix64 output
+// of counter i, so any order can be produced without the ones before it, except for its id,
+// which is a running sum of 1..4 steps. generate() fills blocks of draws in a loop with no
+// carried dependency, then scans the id steps; with several threads each thread first sums
+// the steps of its share, so every share knows its first id and can be written in parallel.
+// The output depends only on the seed, never on the thread count or on how next_order() and
+// generate() calls are interleaved.
 class OrderGenerator {
  public:
   explicit OrderGenerator(std::uint64_t seed = 42);
@@ -14,14 +21,72 @@ class OrderGenerator {
   Order next_order();
 
   std::vector<Order> generate(std::size_t count);
+  // Same orders as generate(count), written by `threads` threads.
+  std::vector<Order> generate(std::size_t count, std::size_t threads);
 
  private:
-  std::mt19937_64 rng_;
+  // Draws for orders [first, first + count) into `out`; returns the id after the last of them.
+  std::uint64_t fill(Order* out, std::uint64_t first, std::size_t count, std::uint64_t id) const;
+  // Sum of the id steps of orders [first, first + count).
+  std::uint64_t id_span(std::uint64_t first, std::size_t count) const;
+
+  std::uint64_t seed_;
+  std::uint64_t counter_;
   std::uint64_t nextId_;
   std::uint64_t baseTimestamp_;
 };
 
+// A queue position in [0, n), position p drawn with weight 1 / (p + 1)^exponent. Inverts the
+// continuous power law, which is cheap for any n and within a fraction of a position of the
+// discrete distribution.
+std::size_t zipf_position(std::size_t n, double exponent, std::mt19937_64& rng);
+
+// How make_query_ids picks the ids it queries. Each query first draws hit or miss, then an order
+// of the book by `pick`; a hit queries that order's id, a miss an id derived by `miss`.
+struct QueryDistribution {
+  enum class Pick {
+    Uniform,       // every order equally likely
+    PositionZipf,  // queue position p (0 = front) with weight 1 / (p + 1)^exponent
+    Recent,        // the order `age` places from the back, `age` geometric of mean mean_age
+    Own,           // `working_set` own (isOwn) orders drawn once, rank r with weight 1 / r^exponent
+  };
+  enum class Miss {
+    NearMiss,    // the first absent id above the picked order: a recently cancelled order
+    AboveRange,  // a random id above the newest order, which searches reject at the right edge
+  };
+
+  Pick pick{Pick::Uniform};
+  Miss miss{Miss::NearMiss};
+  double hit_ratio{0.5};
+  double exponent{1.1};
+  double mean_age{64.0};
+  std::size_t working_set{64};
+};
+
+// `orders` must be sorted by id for near misses to be absent from the book. With Pick::Own and
+// no own orders, the working set is drawn from all orders.
+std::vector<std::uint64_t> make_query_ids(const std::vector<Order>& orders,
+                                          std::size_t count,
+                                          const QueryDistribution& distribution,
+                                          std::mt19937_64& rng);
+
+// Uniform picks with near misses.
 std::vector<std::uint64_t> make_query_ids(const std::vector<Order>& orders,
                                           std::size_t count,
                                           double hit_ratio,
                                           std::mt19937_64& rng);
+
+// Query ids skewed towards the newest orders, as cancels and modifies are: Pick::Recent with
+// near misses.
+std::vector<std::uint64_t> make_recent_query_ids(const std::vector<Order>& orders,
+                                                 std::size_t count,
+                                                 double hit_ratio,
+                                                 double mean_age,
+                                                 std::mt19937_64& rng);
+
+// Query ids from a strategy re-checking its own orders: Pick::Own with every query a hit.
+std::vector<std::uint64_t> make_zipf_query_ids(const std::vector<Order>& orders,
+                                               std::size_t count,
+                                               std::size_t working_set,
+                                               double exponent,
+                                               std::mt19937_64& rng);
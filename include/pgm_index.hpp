@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "order.hpp"
+
+// Learned id -> position index in the style of the PGM index: the ids of a sorted queue are cut
+// into linear segments, each predicting an id's position to within Epsilon. A lookup binary
+// searches the (few) segment start ids, evaluates one line, then searches a window of about
+// 2 * Epsilon orders in the queue itself. The index stores only the segments, so it stays a few
+// KB even for millions of orders whose ids advance almost linearly.
+//
+// Segments are built greedily with a shrinking cone: each new id narrows the range of slopes
+// that keep every id of the last segment within Epsilon, and a new segment starts once that
+// range is empty. push_back() therefore extends the last segment whenever it can, and
+// pop_front() only advances the base offset (segments that end before it are dropped).
+template <std::size_t Epsilon = 64>
+class PgmIdIndex {
+ public:
+  struct Segment {
+    std::uint64_t first_key;
+    std::uint64_t first_pos;
+    double slope;
+  };
+
+  // Live positions [lo, hi) that must contain the lower bound of an id.
+  struct Range {
+    std::size_t lo;
+    std::size_t hi;
+  };
+
+  PgmIdIndex() = default;
+  explicit PgmIdIndex(std::span<const Order> orders) {
+    for (const Order& order : orders) {
+      push_back(order.id);
+    }
+    segments_.shrink_to_fit();
+  }
+
+  std::size_t size() const { return end_ - base_; }
+  bool empty() const { return end_ == base_; }
+  std::size_t segment_count() const { return segments_.size() - first_segment_; }
+  std::size_t memory_bytes() const {
+    return sizeof(*this) + segments_.capacity() * sizeof(Segment);
+  }
+
+  Range search(std::uint64_t id) const {
+    if (empty()) {
+      return {0, 0};
+    }
+    const auto first = segments_.begin() + static_cast<std::ptrdiff_t>(first_segment_);
+    auto it = std::upper_bound(first, segments_.end(), id, [](std::uint64_t key, const Segment& s) {
+      return key < s.first_key;
+    });
+    std::uint64_t predicted = first->first_pos;
+    if (it != first) {
+      const std::uint64_t limit = it == segments_.end() ? end_ : it->first_pos;
+      const Segment& segment = *--it;
+      const double offset = segment.slope * static_cast<double>(id - segment.first_key);
+      predicted = segment.first_pos +
+                  static_cast<std::uint64_t>(
+                      std::min(offset, static_cast<double>(limit - segment.first_pos)));
+    }
+    // One slot of slack each way covers misses between two ids and rounding of the line.
+    constexpr std::uint64_t kSlack = Epsilon + 2;
+    const std::uint64_t lo =
+        std::max<std::uint64_t>(base_, predicted > kSlack ? predicted - kSlack : 0);
+    const std::uint64_t hi = std::max(lo, std::min<std::uint64_t>(end_, predicted + kSlack));
+    return {static_cast<std::size_t>(lo - base_), static_cast<std::size_t>(hi - base_)};
+  }
+
+  // lower_bound over the live queue [first, last) this index describes.
+  template <typename RandomIt>
+  RandomIt lower_bound(RandomIt first, [[maybe_unused]] RandomIt last, std::uint64_t id) const {
+    assert(static_cast<std::size_t>(std::distance(first, last)) == size());
+    const Range range = search(id);
+    return std::lower_bound(first + static_cast<std::ptrdiff_t>(range.lo),
+                            first + static_cast<std::ptrdiff_t>(range.hi), id, OrderIdLess{});
+  }
+
+  void push_back(std::uint64_t id) {
+    const std::uint64_t pos = end_++;
+    if (segment_count() == 0) {
+      start_segment(id, pos);
+      return;
+    }
+    assert(id > last_key_);
+    last_key_ = id;
+    Segment& segment = segments_.back();
+    const double dx = static_cast<double>(id - segment.first_key);
+    const double dy = static_cast<double>(pos - segment.first_pos);
+    const double lo = std::max(cone_lo_, (dy - static_cast<double>(Epsilon)) / dx);
+    const double hi = std::min(cone_hi_, (dy + static_cast<double>(Epsilon)) / dx);
+    if (lo > hi) {
+      start_segment(id, pos);
+      return;
+    }
+    cone_lo_ = lo;
+    cone_hi_ = hi;
+    segment.slope = (lo + hi) / 2;
+  }
+
+  void pop_front() {
+    assert(!empty());
+    ++base_;
+    while (first_segment_ + 1 < segments_.size() &&
+           segments_[first_segment_ + 1].first_pos <= base_) {
+      ++first_segment_;
+    }
+    if (2 * first_segment_ > segments_.size()) {
+      segments_.erase(segments_.begin(),
+                      segments_.begin() + static_cast<std::ptrdiff_t>(first_segment_));
+      first_segment_ = 0;
+    }
+  }
+
+  void clear() {
+    segments_.clear();
+    first_segment_ = 0;
+    base_ = end_ = last_key_ = 0;
+  }
+
+ private:
+  void start_segment(std::uint64_t id, std::uint64_t pos) {
+    segments_.push_back({id, pos, 0.0});
+    last_key_ = id;
+    cone_lo_ = 0.0;
+    cone_hi_ = std::numeric_limits<double>::infinity();
+  }
+
+  std::vector<Segment> segments_;
+  std::size_t first_segment_{0};
+  std::uint64_t base_{0};
+  std::uint64_t end_{0};
+  std::uint64_t last_key_{0};
+  double cone_lo_{0.0};
+  double cone_hi_{0.0};
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "batch_search.hpp"
+#include "id_search.hpp"
+#include "order.hpp"
+#include "vec_deque.hpp"
+
+namespace s_tree_detail {
+
+// Number of keys in a node that are less than `id`.
+struct ScalarRank {
+  template <std::size_t NodeKeys>
+  static std::size_t rank(const std::uint64_t* node, std::uint64_t id) {
+    std::size_t count = 0;
+    for (std::size_t j = 0; j < NodeKeys; ++j) {
+      count += node[j] < id;
+    }
+    return count;
+  }
+};
+
+#if defined(__x86_64__)
+// Four ids per compare. AVX2 only has a signed 64-bit compare, so both sides are flipped by the
+// sign bit first, which maps unsigned order onto signed order (padding ids included).
+struct Avx2Rank {
+  template <std::size_t NodeKeys>
+  [[gnu::target("avx2")]] static std::size_t rank(const std::uint64_t* node, std::uint64_t id) {
+    const __m256i sign = _mm256_set1_epi64x(std::numeric_limits<std::int64_t>::min());
+    const __m256i key = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<std::int64_t>(id)), sign);
+    unsigned mask = 0;
+    for (std::size_t j = 0; j < NodeKeys; j += 4) {
+      const __m256i keys = _mm256_xor_si256(
+          _mm256_load_si256(reinterpret_cast<const __m256i*>(node + j)), sign);
+      const __m256i less = _mm256_cmpgt_epi64(key, keys);
+      mask |= static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(less))) << j;
+    }
+    return static_cast<std::size_t>(std::popcount(mask));
+  }
+};
+#endif
+
+}  // namespace s_tree_detail
+
+// Static k-ary search tree (S+ tree) over order ids. The bottom layer is the sorted ids
+// themselves, padded to whole nodes of NodeKeys ids (one or two cache lines); every node above
+// holds the first id of its 2nd..(NodeKeys + 1)th child, so a lookup reads one node per layer and
+// the answer's index is its leaf position, with no rank table. Nodes are ranked with AVX2
+// compares when the CPU has them (checked at run time, as the build does not enable AVX2) and
+// with a plain loop otherwise.
+//
+// The tree can follow a queue that churns at its ends: pop_front() only advances the live start
+// inside the leaves, and push_back() appends to a sorted tail that is searched after the tree.
+// Once the tail outgrows 1/kRebuildDivisor of the tree, or half of the leaves are dead, the live
+// ids are rebuilt into a fresh tree, so rebuilds cost O(1) amortised per churn operation.
+template <std::size_t NodeKeys = 16>
+class STreeIdSearch {
+  static_assert(NodeKeys == 8 || NodeKeys == 16, "a node is one or two cache lines of ids");
+  static constexpr std::size_t kFanout = NodeKeys + 1;
+  static constexpr std::uint64_t kPad = std::numeric_limits<std::uint64_t>::max();
+
+ public:
+  static constexpr std::size_t kRebuildDivisor = 16;
+  static constexpr std::size_t kMinTail = 64;
+
+  explicit STreeIdSearch(std::span<const Order> orders) { assign(collect_ids(orders, {})); }
+
+  template <typename Allocator>
+  explicit STreeIdSearch(const VecDeque<Order, Allocator>& snapshot) {
+    const auto [first, second] = snapshot.as_slices();
+    assign(collect_ids(first, second));
+  }
+
+  std::size_t size() const { return leaf_count_ - front_ + tail_.size(); }
+
+  // Index of the first live id not less than `id`, or size().
+  std::size_t lower_bound(std::uint64_t id) const {
+#if defined(__x86_64__)
+    if (use_avx2_) {
+      return finish(id, descend_avx2(id));
+    }
+#endif
+    return finish(id, descend<s_tree_detail::ScalarRank>(id));
+  }
+
+  // lower_bound for each of `ids`. Groups of `batch` lookups descend layer by layer together,
+  // prefetching every lookup's next node before any of them is ranked.
+  void lower_bound_many(std::span<const std::uint64_t> ids,
+                        std::span<std::size_t> out,
+                        std::size_t batch = kDefaultFindBatch) const {
+    batch = std::clamp<std::size_t>(batch, 1, kMaxFindBatch);
+#if defined(__x86_64__)
+    if (use_avx2_) {
+      descend_many_avx2(ids, out, batch);
+    } else
+#endif
+    {
+      descend_many<s_tree_detail::ScalarRank>(ids, out, batch);
+    }
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+      out[i] = finish(ids[i], out[i]);
+    }
+  }
+
+  void pop_front() {
+    assert(size() > 0);
+    if (front_ == leaf_count_) {
+      tail_.erase(tail_.begin());
+      return;
+    }
+    ++front_;
+    if (front_ > kMinTail && 2 * front_ > leaf_count_) {
+      rebuild();
+    }
+  }
+
+  void push_back(std::uint64_t id) {
+    assert(size() == 0 || id > back());
+    tail_.push_back(id);
+    if (tail_.size() > std::max(kMinTail, (leaf_count_ - front_) / kRebuildDivisor)) {
+      rebuild();
+    }
+  }
+
+  std::uint64_t back() const {
+    assert(size() > 0);
+    return tail_.empty() ? leaves()[leaf_count_ - 1] : tail_.back();
+  }
+
+  // Folds the tail into the tree and drops the popped ids.
+  void rebuild() {
+    std::vector<std::uint64_t> ids;
+    ids.reserve(size());
+    ids.insert(ids.end(), leaves() + front_, leaves() + leaf_count_);
+    ids.insert(ids.end(), tail_.begin(), tail_.end());
+    assign(std::move(ids));
+  }
+
+ private:
+  static std::vector<std::uint64_t> collect_ids(std::span<const Order> first,
+                                                std::span<const Order> second) {
+    std::vector<std::uint64_t> ids;
+    ids.reserve(first.size() + second.size());
+    for (const auto part : {first, second}) {
+      for (const Order& order : part) {
+        ids.push_back(order.id);
+      }
+    }
+    return ids;
+  }
+
+  // Lays `ids` out as layers of nodes, root first and leaves last.
+  void assign(std::vector<std::uint64_t> ids) {
+    leaf_count_ = ids.size();
+    front_ = 0;
+    tail_.clear();
+
+    std::vector<std::size_t> nodes{
+        std::max<std::size_t>(1, (ids.size() + NodeKeys - 1) / NodeKeys)};
+    while (nodes.back() > 1) {
+      nodes.push_back((nodes.back() + kFanout - 1) / kFanout);
+    }
+    std::reverse(nodes.begin(), nodes.end());
+    layer_offsets_.assign(nodes.size(), 0);
+    std::size_t total = 0;
+    for (std::size_t layer = 0; layer < nodes.size(); ++layer) {
+      layer_offsets_[layer] = total;
+      total += nodes[layer] * NodeKeys;
+    }
+    keys_ = id_search_detail::make_aligned_keys(total);
+
+    std::uint64_t* leaf = keys_.get() + layer_offsets_.back();
+    std::copy(ids.begin(), ids.end(), leaf);
+    std::fill(leaf + ids.size(), leaf + nodes.back() * NodeKeys, kPad);
+    // A node `height` layers above the leaves spans kFanout^height leaf nodes; its separator j
+    // is the first id of child j + 1, i.e. of that child's leftmost leaf.
+    std::size_t leaves_per_child = 1;
+    for (std::size_t layer = nodes.size() - 1; layer-- > 0;) {
+      std::uint64_t* node_keys = keys_.get() + layer_offsets_[layer];
+      for (std::size_t k = 0; k < nodes[layer]; ++k) {
+        for (std::size_t j = 0; j < NodeKeys; ++j) {
+          const std::size_t first = (k * kFanout + j + 1) * leaves_per_child * NodeKeys;
+          node_keys[k * NodeKeys + j] = first < ids.size() ? ids[first] : kPad;
+        }
+      }
+      leaves_per_child *= kFanout;
+    }
+  }
+
+  const std::uint64_t* leaves() const { return keys_.get() + layer_offsets_.back(); }
+
+  // Maps a position among all leaf ids to a live index, continuing into the tail for ids past
+  // the tree.
+  std::size_t finish(std::uint64_t id, std::size_t pos) const {
+    if (pos == leaf_count_ || front_ == leaf_count_) {
+      return leaf_count_ - front_ +
+             static_cast<std::size_t>(std::lower_bound(tail_.begin(), tail_.end(), id) -
+                                      tail_.begin());
+    }
+    return std::max(pos, front_) - front_;
+  }
+
+  // Inlined into each dispatch target so the rank compiles with that target's instructions.
+  template <typename Rank>
+  [[gnu::always_inline]] std::size_t descend(std::uint64_t id) const {
+    const std::uint64_t* keys = keys_.get();
+    const std::size_t leaf_layer = layer_offsets_.size() - 1;
+    std::size_t k = 0;
+    for (std::size_t layer = 0; layer < leaf_layer; ++layer) {
+      k = k * kFanout +
+          Rank::template rank<NodeKeys>(keys + layer_offsets_[layer] + k * NodeKeys, id);
+    }
+    return k * NodeKeys +
+           Rank::template rank<NodeKeys>(keys + layer_offsets_[leaf_layer] + k * NodeKeys, id);
+  }
+
+  template <typename Rank>
+  [[gnu::always_inline]] void descend_many(std::span<const std::uint64_t> ids,
+                                           std::span<std::size_t> out,
+                                           std::size_t batch) const {
+    const std::uint64_t* keys = keys_.get();
+    const std::size_t leaf_layer = layer_offsets_.size() - 1;
+    std::size_t node[kMaxFindBatch];
+    for (std::size_t first = 0; first < ids.size(); first += batch) {
+      const std::size_t count = std::min(batch, ids.size() - first);
+      std::fill(node, node + count, 0);
+      for (std::size_t layer = 0; layer < leaf_layer; ++layer) {
+        const std::uint64_t* layer_keys = keys + layer_offsets_[layer];
+        const std::uint64_t* next_keys = keys + layer_offsets_[layer + 1];
+        for (std::size_t j = 0; j < count; ++j) {
+          node[j] = node[j] * kFanout +
+                    Rank::template rank<NodeKeys>(layer_keys + node[j] * NodeKeys, ids[first + j]);
+          const std::uint64_t* next = next_keys + node[j] * NodeKeys;
+          __builtin_prefetch(next);
+          if constexpr (NodeKeys > id_search_detail::kKeysPerLine) {
+            __builtin_prefetch(next + id_search_detail::kKeysPerLine);
+          }
+        }
+      }
+      const std::uint64_t* leaf_keys = keys + layer_offsets_[leaf_layer];
+      for (std::size_t j = 0; j < count; ++j) {
+        out[first + j] = node[j] * NodeKeys + Rank::template rank<NodeKeys>(
+                                                  leaf_keys + node[j] * NodeKeys, ids[first + j]);
+      }
+    }
+  }
+
+#if defined(__x86_64__)
+  [[gnu::target("avx2")]] std::size_t descend_avx2(std::uint64_t id) const {
+    return descend<s_tree_detail::Avx2Rank>(id);
+  }
+
+  [[gnu::target("avx2")]] void descend_many_avx2(std::span<const std::uint64_t> ids,
+                                                 std::span<std::size_t> out,
+                                                 std::size_t batch) const {
+    descend_many<s_tree_detail::Avx2Rank>(ids, out, batch);
+  }
+
+  bool use_avx2_{__builtin_cpu_supports("avx2") != 0};
+#endif
+
+  id_search_detail::AlignedKeys keys_;
+  std::vector<std::size_t> layer_offsets_;
+  std::size_t leaf_count_{0};
+  std::size_t front_{0};
+  std::vector<std::uint64_t> tail_;
+};
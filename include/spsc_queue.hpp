@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <thread>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+inline void spsc_cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#endif
+}
+
+// Spins on the counter; after a long run of empty polls it yields so an oversubscribed machine
+// still makes progress. Suited to core-pinned producer/consumer pairs.
+struct BusyPollWait {
+  template <typename Counter>
+  static void wait(const std::atomic<Counter>& counter, Counter observed) {
+    for (unsigned spins = 0; counter.load(std::memory_order_acquire) == observed; ++spins) {
+      if ((spins & 1023u) == 1023u) {
+        std::this_thread::yield();
+      } else {
+        spsc_cpu_relax();
+      }
+    }
+  }
+  template <typename Counter>
+  static void notify(std::atomic<Counter>&) {}
+};
+
+// Sleeps in the kernel through std::atomic::wait (a futex on Linux); every publish or consume
+// notifies. Trades wake-up latency for an idle core when traffic is sparse.
+struct FutexWait {
+  template <typename Counter>
+  static void wait(const std::atomic<Counter>& counter, Counter observed) {
+    counter.wait(observed, std::memory_order_acquire);
+  }
+  template <typename Counter>
+  static void notify(std::atomic<Counter>& counter) {
+    counter.notify_one();
+  }
+};
+
+// Bounded lock-free single-producer/single-consumer queue. Capacity is rounded up to a power of
+// two; head and tail are free-running counters masked on access, like VecDeque's ring.
+//
+// Producer and consumer state live on separate cache lines. Each side keeps a cached copy of
+// the other side's counter and only reloads the shared atomic when the cache says the queue
+// is full (producer) or empty (consumer). Batch calls publish or release a whole run of slots
+// with one release store.
+template <typename T, typename WaitStrategy = BusyPollWait>
+class SpscQueue {
+  static_assert(std::is_trivially_copyable_v<T>, "SpscQueue slots are copied without ownership");
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  explicit SpscQueue(size_type capacity)
+      : capacity_(next_power_of_two(capacity)),
+        mask_(capacity_ - 1),
+        slots_(std::make_unique<T[]>(capacity_)) {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  size_type capacity() const { return capacity_; }
+
+  // Producer side.
+  bool try_push(const T& value) { return try_push_batch(std::span<const T>(&value, 1)) == 1; }
+
+  // Publishes as many of `values` as fit; returns how many were enqueued.
+  size_type try_push_batch(std::span<const T> values) {
+    const size_type tail = producer_.tail;
+    size_type free_slots = capacity_ - (tail - producer_.cached_head);
+    if (free_slots < values.size()) {
+      producer_.cached_head = head_.load(std::memory_order_acquire);
+      free_slots = capacity_ - (tail - producer_.cached_head);
+    }
+    const size_type count = std::min(free_slots, values.size());
+    if (count == 0) {
+      return 0;
+    }
+    for (size_type i = 0; i < count; ++i) {
+      slots_[(tail + i) & mask_] = values[i];
+    }
+    producer_.tail = tail + count;
+    tail_.store(producer_.tail, std::memory_order_release);
+    WaitStrategy::notify(tail_);
+    return count;
+  }
+
+  // Blocks (per WaitStrategy) until every value has been published.
+  void push_batch(std::span<const T> values) {
+    while (!values.empty()) {
+      const size_type pushed = try_push_batch(values);
+      if (pushed == 0) {
+        WaitStrategy::wait(head_, producer_.cached_head);
+        continue;
+      }
+      values = values.subspan(pushed);
+    }
+  }
+
+  void push(const T& value) { push_batch(std::span<const T>(&value, 1)); }
+
+  // Consumer side.
+  bool try_pop(T& out) { return try_pop_batch(std::span<T>(&out, 1)) == 1; }
+
+  // Copies up to out.size() elements and releases their slots; returns how many were taken.
+  size_type try_pop_batch(std::span<T> out) {
+    const size_type head = consumer_.head;
+    size_type available = consumer_.cached_tail - head;
+    if (available < out.size()) {
+      consumer_.cached_tail = tail_.load(std::memory_order_acquire);
+      available = consumer_.cached_tail - head;
+    }
+    const size_type count = std::min(available, out.size());
+    if (count == 0) {
+      return 0;
+    }
+    for (size_type i = 0; i < count; ++i) {
+      out[i] = slots_[(head + i) & mask_];
+    }
+    consumer_.head = head + count;
+    head_.store(consumer_.head, std::memory_order_release);
+    WaitStrategy::notify(head_);
+    return count;
+  }
+
+  // Blocks (per WaitStrategy) until at least one element is available.
+  size_type pop_batch(std::span<T> out) {
+    for (;;) {
+      const size_type popped = try_pop_batch(out);
+      if (popped > 0 || out.empty()) {
+        return popped;
+      }
+      WaitStrategy::wait(tail_, consumer_.cached_tail);
+    }
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  static constexpr size_type kCacheLine = 64;
+
+  static size_type next_power_of_two(size_type n) {
+    size_type cap = 1;
+    while (cap < n) {
+      cap <<= 1;
+    }
+    return cap;
+  }
+
+  struct alignas(kCacheLine) ProducerState {
+    size_type tail{0};
+    size_type cached_head{0};
+  };
+
+  struct alignas(kCacheLine) ConsumerState {
+    size_type head{0};
+    size_type cached_tail{0};
+  };
+
+  const size_type capacity_;
+  const size_type mask_;
+  std::unique_ptr<T[]> slots_;
+  alignas(kCacheLine) std::atomic<size_type> head_{0};
+  alignas(kCacheLine) std::atomic<size_type> tail_{0};
+  ProducerState producer_;
+  ConsumerState consumer_;
+};
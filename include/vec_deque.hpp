@@ -1,16 +1,58 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <memory>
+#include <span>
 #include <type_traits>
 #include <utility>
 
+#include "batch_search.hpp"
+#include "finger_cache.hpp"
+#include "galloping_search.hpp"
+#include "interpolation_search.hpp"
+
+namespace vec_deque_detail {
+
+template <typename T, std::size_t N>
+struct InlineStorage {
+  T* data() { return reinterpret_cast<T*>(bytes); }
+  const T* data() const { return reinterpret_cast<const T*>(bytes); }
+
+  alignas(T) std::byte bytes[N * sizeof(T)];
+};
+
+template <typename T>
+struct InlineStorage<T, 0> {
+  T* data() { return nullptr; }
+  const T* data() const { return nullptr; }
+};
+
+}  // namespace vec_deque_detail
+
 // A minimal Rust-like VecDeque implemented as a power-of-two ring buffer.
 // Supports push/pop at both ends, random access, and random-access iterators.
-template <typename T, typename Allocator = std::allocator<T>>
+// With an allocator that mirrors rings (see mirrored_allocator.hpp) large buffers are mapped
+// twice back to back and every logical range is contiguous in memory.
+// A non-zero InlineCapacity keeps the first InlineCapacity elements inside the object itself;
+// the ring only moves to the allocator once it outgrows that buffer. A non-zero FingerSlots
+// makes the non-const find_by_id remember the physical slots of the last FingerSlots ids it
+// found; the const overload never touches that cache.
+template <typename T,
+          typename Allocator = std::allocator<T>,
+          std::size_t InlineCapacity = 0,
+          std::size_t FingerSlots = 0>
 class VecDeque {
+  static constexpr bool kMirrorCapable = requires { Allocator::mirrors_ring; };
+  static_assert(!kMirrorCapable || std::is_trivially_copyable_v<T>,
+                "Mirrored rings alias every slot at two addresses; T must be trivially copyable");
+  static_assert((InlineCapacity & (InlineCapacity - 1)) == 0,
+                "InlineCapacity must be zero or a power of two");
+
  public:
   using value_type = T;
   using allocator_type = Allocator;
@@ -22,21 +64,47 @@ class VecDeque {
   VecDeque() = default;
   explicit VecDeque(const Allocator& alloc) : alloc_(alloc) {}
 
-  VecDeque(const VecDeque& other) { copy_from(other); }
-  VecDeque(VecDeque&& other) noexcept { move_from(std::move(other)); }
+  VecDeque(const VecDeque& other)
+      : alloc_(AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+    copy_from(other);
+  }
+  VecDeque(const VecDeque& other, const Allocator& alloc) : alloc_(alloc) { copy_from(other); }
+  VecDeque(VecDeque&& other) noexcept : alloc_(std::move(other.alloc_)) {
+    move_from(std::move(other));
+  }
+  VecDeque(VecDeque&& other, const Allocator& alloc) : alloc_(alloc) {
+    if (alloc_ == other.alloc_) {
+      move_from(std::move(other));
+    } else {
+      move_elements_from(std::move(other));
+    }
+  }
 
   VecDeque& operator=(const VecDeque& other) {
     if (this != &other) {
-      clear();
+      destroy_storage();
+      if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+        alloc_ = other.alloc_;
+      }
       copy_from(other);
     }
     return *this;
   }
 
-  VecDeque& operator=(VecDeque&& other) noexcept {
+  VecDeque& operator=(VecDeque&& other) noexcept(
+      AllocTraits::propagate_on_container_move_assignment::value ||
+      AllocTraits::is_always_equal::value) {
     if (this != &other) {
       destroy_storage();
-      move_from(std::move(other));
+      if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+        alloc_ = std::move(other.alloc_);
+        move_from(std::move(other));
+      } else if (alloc_ == other.alloc_) {
+        move_from(std::move(other));
+      } else {
+        // Storage owned by a different resource cannot be adopted; move element-wise.
+        move_elements_from(std::move(other));
+      }
     }
     return *this;
   }
@@ -48,6 +116,7 @@ class VecDeque {
   bool empty() const { return size_ == 0; }
   size_type size() const { return size_; }
   size_type capacity() const { return capacity_; }
+  bool mirrored() const { return mirrored_; }
 
   reference front() { return (*this)[0]; }
   const_reference front() const { return (*this)[0]; }
@@ -113,6 +182,9 @@ class VecDeque {
     --size_;
   }
 
+  // Iterators hold a raw pointer into the buffer and wrap only when they step off its physical
+  // end, so dereference is a plain load and a linear scan is a pointer bump plus one compare.
+  // The logical index is carried alongside for ordering, distance and equality.
   template <bool IsConst>
   class iterator_base {
    public:
@@ -124,11 +196,21 @@ class VecDeque {
 
     iterator_base() = default;
 
-    reference operator*() const { return deque_->operator[](index_); }
-    pointer operator->() const { return &deque_->operator[](index_); }
+    template <bool B = IsConst, typename = std::enable_if_t<B>>
+    iterator_base(const iterator_base<false>& other)
+        : ptr_(other.ptr_),
+          buffer_(other.buffer_),
+          buffer_end_(other.buffer_end_),
+          index_(other.index_) {}
+
+    reference operator*() const { return *ptr_; }
+    pointer operator->() const { return ptr_; }
 
     iterator_base& operator++() {
       ++index_;
+      if (++ptr_ == buffer_end_) {
+        ptr_ = buffer_;
+      }
       return *this;
     }
     iterator_base operator++(int) {
@@ -138,6 +220,10 @@ class VecDeque {
     }
     iterator_base& operator--() {
       --index_;
+      if (ptr_ == buffer_) {
+        ptr_ = buffer_end_;
+      }
+      --ptr_;
       return *this;
     }
     iterator_base operator--(int) {
@@ -147,12 +233,14 @@ class VecDeque {
     }
     iterator_base& operator+=(difference_type n) {
       index_ += n;
+      if (buffer_ != buffer_end_) {
+        const auto mask = static_cast<size_type>(buffer_end_ - buffer_) - 1;
+        const auto offset = static_cast<size_type>(ptr_ - buffer_) + static_cast<size_type>(n);
+        ptr_ = buffer_ + (offset & mask);
+      }
       return *this;
     }
-    iterator_base& operator-=(difference_type n) {
-      index_ -= n;
-      return *this;
-    }
+    iterator_base& operator-=(difference_type n) { return *this += -n; }
     iterator_base operator+(difference_type n) const {
       iterator_base tmp = *this;
       tmp += n;
@@ -166,9 +254,7 @@ class VecDeque {
     difference_type operator-(const iterator_base& other) const { return index_ - other.index_; }
     reference operator[](difference_type n) const { return *(*this + n); }
 
-    bool operator==(const iterator_base& other) const {
-      return deque_ == other.deque_ && index_ == other.index_;
-    }
+    bool operator==(const iterator_base& other) const { return index_ == other.index_; }
     bool operator!=(const iterator_base& other) const { return !(*this == other); }
     bool operator<(const iterator_base& other) const { return index_ < other.index_; }
     bool operator>(const iterator_base& other) const { return other < *this; }
@@ -179,9 +265,15 @@ class VecDeque {
     friend class VecDeque;
     using DequePtr = std::conditional_t<IsConst, const VecDeque*, VecDeque*>;
 
-    iterator_base(DequePtr deque, size_type idx) : deque_(deque), index_(idx) {}
+    iterator_base(DequePtr deque, size_type idx)
+        : ptr_(deque->data_ + deque->physical_index(idx)),
+          buffer_(deque->data_),
+          buffer_end_(deque->data_ + (deque->mirrored_ ? 2 : 1) * deque->capacity_),
+          index_(idx) {}
 
-    DequePtr deque_{nullptr};
+    pointer ptr_{nullptr};
+    pointer buffer_{nullptr};
+    pointer buffer_end_{nullptr};
     size_type index_{0};
   };
 
@@ -195,12 +287,99 @@ class VecDeque {
   const_iterator cbegin() const { return begin(); }
   const_iterator cend() const { return end(); }
 
+  // The live elements as two contiguous physical segments: [head, end of buffer) and the
+  // wrapped part starting at slot 0. The second span is empty when the ring does not wrap.
+  std::pair<std::span<T>, std::span<T>> as_slices() {
+    const size_type first_len = mirrored_ ? size_ : std::min(size_, capacity_ - head_);
+    return {std::span<T>(data_ + head_, first_len), std::span<T>(data_, size_ - first_len)};
+  }
+  std::pair<std::span<const T>, std::span<const T>> as_slices() const {
+    const size_type first_len = mirrored_ ? size_ : std::min(size_, capacity_ - head_);
+    return {std::span<const T>(data_ + head_, first_len),
+            std::span<const T>(data_, size_ - first_len)};
+  }
+
+  // Logical range [first, last) as a single span. Always valid on a mirrored buffer; otherwise
+  // the range must not cross the physical end of the buffer.
+  std::span<T> contiguous_range(size_type first, size_type last) {
+    assert(mirrored_ || last == first || physical_index(first) + (last - first) <= capacity_);
+    return std::span<T>(data_ + physical_index(first), last - first);
+  }
+  std::span<const T> contiguous_range(size_type first, size_type last) const {
+    assert(mirrored_ || last == first || physical_index(first) + (last - first) <= capacity_);
+    return std::span<const T>(data_ + physical_index(first), last - first);
+  }
+
+  // lower_bound over a sorted deque that picks the physical segment holding the answer with one
+  // comparison, then binary-searches raw pointers instead of going through iterator_base.
+  template <typename Key, typename Compare>
+  iterator lower_bound(const Key& key, Compare comp) {
+    return iterator(this, lower_bound_index(key, comp));
+  }
+  template <typename Key, typename Compare>
+  const_iterator lower_bound(const Key& key, Compare comp) const {
+    return const_iterator(this, lower_bound_index(key, comp));
+  }
+
+  iterator lower_bound_by_id(std::uint64_t id) { return lower_bound(id, IdLess{}); }
+  const_iterator lower_bound_by_id(std::uint64_t id) const { return lower_bound(id, IdLess{}); }
+
+  // Same result as lower_bound_by_id, but probes the interpolated position of `id` inside the
+  // chosen segment first (see interpolation_search.hpp). Pays off when ids are dense.
+  iterator interpolation_lower_bound_by_id(std::uint64_t id) {
+    return iterator(this, interpolation_index(id));
+  }
+  const_iterator interpolation_lower_bound_by_id(std::uint64_t id) const {
+    return const_iterator(this, interpolation_index(id));
+  }
+
+  // Same result as lower_bound_by_id, galloping in from whichever end of the chosen segment is
+  // nearer `id` (see galloping_search.hpp), so lookups of recent orders stay near the tail.
+  iterator gallop_lower_bound_by_id(std::uint64_t id) { return iterator(this, gallop_index(id)); }
+  const_iterator gallop_lower_bound_by_id(std::uint64_t id) const {
+    return const_iterator(this, gallop_index(id));
+  }
+
+  // Element whose id equals `id` in a deque sorted by id, or end(). Remembered slots are tried
+  // first and trusted only if they still hold `id`, so any mutation merely costs a miss.
+  iterator find_by_id(std::uint64_t id) { return iterator(this, find_index(id)); }
+  const_iterator find_by_id(std::uint64_t id) const {
+    return const_iterator(this, find_index(id));
+  }
+
+  const FingerCache<size_type, FingerSlots>& finger_cache() const { return fingers_; }
+
+  // Batched find over a deque sorted by id: out[i] is the logical index of the element whose id
+  // equals ids[i], or size() when there is none. Up to `batch` searches run in lock-step with
+  // prefetched probes (see batch_search.hpp).
+  void find_many(std::span<const std::uint64_t> ids,
+                 std::span<size_type> out,
+                 size_type batch = kDefaultFindBatch) const {
+    const auto at = [this](size_type i) -> const T* { return data_ + physical_index(i); };
+    lockstep_lower_bound(size_, at, ids, out, batch);
+    for (size_type i = 0; i < ids.size(); ++i) {
+      if (out[i] < size_ && at(out[i])->id != ids[i]) {
+        out[i] = size_;
+      }
+    }
+  }
+
   iterator erase(iterator pos) {
     if (pos == end()) {
       return pos;
     }
     size_type idx = pos - begin();
-    if (idx < size_ / 2) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      // Close the gap from the shorter side with bulk moves over the physical segments.
+      if (idx < size_ / 2) {
+        wrap_copy(0, 1, idx);
+        head_ = inc_index(head_);
+      } else {
+        wrap_copy(idx + 1, idx, size_ - idx - 1);
+      }
+      --size_;
+      return iterator(this, idx);
+    } else if (idx < size_ / 2) {
       for (size_type i = idx; i > 0; --i) {
         (*this)[i] = std::move((*this)[i - 1]);
       }
@@ -215,23 +394,86 @@ class VecDeque {
     }
   }
 
+  iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+  iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    const size_type idx = pos.index_;
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      // Build the value first: args may refer to an element that is about to move.
+      T value(std::forward<Args>(args)...);
+      ensure_capacity(size_ + 1);
+      if (idx < size_ / 2) {
+        head_ = dec_index(head_);
+        ++size_;
+        wrap_copy(1, 0, idx);
+      } else {
+        wrap_copy(idx, idx + 1, size_ - idx);
+        ++size_;
+      }
+      construct_at(physical_index(idx), std::move(value));
+    } else {
+      T value(std::forward<Args>(args)...);
+      if (idx == 0) {
+        emplace_front(std::move(value));
+        return iterator(this, idx);
+      }
+      if (idx == size_) {
+        emplace_back(std::move(value));
+        return iterator(this, idx);
+      }
+      // Reserve first so the element duplicated at the open end is not moved from under us.
+      ensure_capacity(size_ + 1);
+      if (idx < size_ / 2) {
+        emplace_front(std::move(front()));
+        for (size_type i = 1; i < idx; ++i) {
+          (*this)[i] = std::move((*this)[i + 1]);
+        }
+      } else {
+        emplace_back(std::move(back()));
+        for (size_type i = size_ - 2; i > idx; --i) {
+          (*this)[i] = std::move((*this)[i - 1]);
+        }
+      }
+      (*this)[idx] = std::move(value);
+    }
+    return iterator(this, idx);
+  }
+
  private:
   using AllocTraits = std::allocator_traits<Allocator>;
 
-  T* data_{nullptr};
+  T* data_{inline_.data()};
   Allocator alloc_{};
-  size_type capacity_{0};
+  size_type capacity_{InlineCapacity};
   size_type head_{0};
   size_type size_{0};
+  bool mirrored_{false};
+
+  [[no_unique_address]] vec_deque_detail::InlineStorage<T, InlineCapacity> inline_;
+  [[no_unique_address]] FingerCache<size_type, FingerSlots> fingers_;
 
+  bool using_heap() const { return data_ && data_ != inline_.data(); }
+
+  // Releases any heap buffer and falls back to the (possibly empty) inline buffer.
   void destroy_storage() {
     clear();
-    if (data_) {
+    if (using_heap()) {
       AllocTraits::deallocate(alloc_, data_, capacity_);
-      data_ = nullptr;
     }
-    capacity_ = 0;
+    data_ = inline_.data();
+    capacity_ = InlineCapacity;
     head_ = 0;
+    mirrored_ = false;
+  }
+
+  static bool mirrors(size_type cap) {
+    if constexpr (kMirrorCapable) {
+      return cap > 0 && Allocator::is_mirrored(cap);
+    } else {
+      return false;
+    }
   }
 
   static size_type next_power_of_two(size_type n) {
@@ -259,12 +501,13 @@ class VecDeque {
       AllocTraits::construct(alloc_, new_data + i, std::move((*this)[i]));
       destroy_at(physical_index(i));
     }
-    if (data_) {
+    if (using_heap()) {
       AllocTraits::deallocate(alloc_, data_, capacity_);
     }
     data_ = new_data;
     capacity_ = new_cap;
     head_ = 0;
+    mirrored_ = mirrors(new_cap);
   }
 
   template <typename... Args>
@@ -284,32 +527,142 @@ class VecDeque {
     return (head_ + logical_index) & mask;
   }
 
+  struct IdLess {
+    bool operator()(const T& value, std::uint64_t id) const { return value.id < id; }
+  };
+
+  template <typename Key, typename Compare>
+  size_type lower_bound_index(const Key& key, Compare comp) const {
+    const auto [first, second] = as_slices();
+    if (second.empty() || !comp(second.front(), key)) {
+      const T* it = std::lower_bound(first.data(), first.data() + first.size(), key, comp);
+      return static_cast<size_type>(it - first.data());
+    }
+    const T* it = std::lower_bound(second.data(), second.data() + second.size(), key, comp);
+    return first.size() + static_cast<size_type>(it - second.data());
+  }
+
+  size_type interpolation_index(std::uint64_t id) const {
+    const auto [first, second] = as_slices();
+    const auto proj = [](const T& value) -> std::uint64_t { return value.id; };
+    if (second.empty() || second.front().id >= id) {
+      const T* it =
+          interpolation_lower_bound(first.data(), first.data() + first.size(), id, proj);
+      return static_cast<size_type>(it - first.data());
+    }
+    const T* it =
+        interpolation_lower_bound(second.data(), second.data() + second.size(), id, proj);
+    return first.size() + static_cast<size_type>(it - second.data());
+  }
+
+  size_type find_index(std::uint64_t id) const {
+    const size_type index = lower_bound_index(id, IdLess{});
+    if (index == size_ || (*this)[index].id != id) {
+      return size_;
+    }
+    return index;
+  }
+
+  // find_index for the non-const find_by_id, trying the finger cache first.
+  size_type find_index(std::uint64_t id) {
+    if (const size_type* slot = fingers_.find(id)) {
+      const size_type index = (*slot - head_) & (capacity_ - 1);
+      if (*slot < capacity_ && index < size_ && data_[*slot].id == id) {
+        fingers_.record_hit();
+        return index;
+      }
+    }
+    const size_type index = std::as_const(*this).find_index(id);
+    if (index != size_) {
+      fingers_.remember(id, physical_index(index));
+    }
+    return index;
+  }
+
+  size_type gallop_index(std::uint64_t id) const {
+    const auto [first, second] = as_slices();
+    const auto proj = [](const T& value) -> std::uint64_t { return value.id; };
+    if (second.empty() || second.front().id >= id) {
+      const T* it = gallop_lower_bound(first.data(), first.data() + first.size(), id, proj);
+      return static_cast<size_type>(it - first.data());
+    }
+    const T* it = gallop_lower_bound(second.data(), second.data() + second.size(), id, proj);
+    return first.size() + static_cast<size_type>(it - second.data());
+  }
+
+  // Moves `count` elements from logical index `src` to logical index `dst`; the ranges may
+  // overlap. Splits at the physical end of either range, so a shift by one costs at most two
+  // segment memmoves plus the single element that crosses the wrap.
+  void wrap_copy(size_type src, size_type dst, size_type count) {
+    if (count == 0 || src == dst) {
+      return;
+    }
+    if (dst < src) {
+      for (size_type done = 0; done < count;) {
+        const size_type from = physical_index(src + done);
+        const size_type to = physical_index(dst + done);
+        const size_type chunk = std::min({count - done, capacity_ - from, capacity_ - to});
+        std::memmove(data_ + to, data_ + from, chunk * sizeof(T));
+        done += chunk;
+      }
+    } else {
+      for (size_type remaining = count; remaining > 0;) {
+        const size_type from_end = physical_index(src + remaining - 1) + 1;
+        const size_type to_end = physical_index(dst + remaining - 1) + 1;
+        const size_type chunk = std::min({remaining, from_end, to_end});
+        std::memmove(data_ + to_end - chunk, data_ + from_end - chunk, chunk * sizeof(T));
+        remaining -= chunk;
+      }
+    }
+  }
+
   size_type inc_index(size_type idx) const { return (idx + 1) & (capacity_ - 1); }
   size_type dec_index(size_type idx) const { return (idx - 1) & (capacity_ - 1); }
 
+  // copy_from/move_from expect fresh storage (constructed or after destroy_storage()).
   void copy_from(const VecDeque& other) {
     if (other.size_ == 0) {
       return;
     }
-    capacity_ = next_power_of_two(other.size_);
+    if (other.size_ > capacity_) {
+      capacity_ = next_power_of_two(other.size_);
+      mirrored_ = mirrors(capacity_);
+      data_ = AllocTraits::allocate(alloc_, capacity_);
+    }
     head_ = 0;
     size_ = other.size_;
-    alloc_ = AllocTraits::select_on_container_copy_construction(other.alloc_);
-    data_ = AllocTraits::allocate(alloc_, capacity_);
     for (size_type i = 0; i < size_; ++i) {
       AllocTraits::construct(alloc_, data_ + i, other[i]);
     }
   }
 
   void move_from(VecDeque&& other) {
+    if (!other.using_heap()) {
+      // Inline elements cannot be adopted by pointer; they always fit our own inline buffer.
+      for (size_type i = 0; i < other.size_; ++i) {
+        construct_at(i, std::move(other[i]));
+      }
+      size_ = other.size_;
+      other.clear();
+      return;
+    }
     data_ = other.data_;
-    alloc_ = std::move(other.alloc_);
     capacity_ = other.capacity_;
     head_ = other.head_;
     size_ = other.size_;
-    other.data_ = nullptr;
-    other.capacity_ = 0;
+    mirrored_ = other.mirrored_;
+    other.data_ = other.inline_.data();
+    other.capacity_ = InlineCapacity;
     other.head_ = 0;
     other.size_ = 0;
+    other.mirrored_ = false;
+  }
+
+  void move_elements_from(VecDeque&& other) {
+    reserve(other.size_);
+    for (size_type i = 0; i < other.size_; ++i) {
+      emplace_back(std::move(other[i]));
+    }
+    other.destroy_storage();
   }
 };
@@ -0,0 +1,236 @@
+#include "book_manager.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <thread>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/hash/hash.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "order_generator.hpp"
+#include "spsc_queue.hpp"
+
+struct BookManager::Shard {
+  // Books and the map's slots both come from the shard's pool; the map hands that allocator to
+  // each book it constructs.
+  using BookMap = absl::flat_hash_map<
+      std::uint32_t,
+      InstrumentBook,
+      absl::Hash<std::uint32_t>,
+      std::equal_to<std::uint32_t>,
+      std::pmr::polymorphic_allocator<std::pair<const std::uint32_t, InstrumentBook>>>;
+
+  explicit Shard(std::size_t ingress_capacity)
+      : ingress(ingress_capacity), books(BookMap::allocator_type(&pool)) {}
+
+  SpscQueue<BookEvent> ingress;
+  std::pmr::unsynchronized_pool_resource pool;
+  BookMap books;
+  std::uint64_t submitted{0};
+  alignas(64) std::atomic<std::uint64_t> processed{0};
+  std::thread worker;
+};
+
+namespace {
+
+std::size_t core_count() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+#if defined(__linux__)
+void pin_to_core(pthread_t thread, std::size_t core) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(static_cast<int>(core % core_count()), &set);
+  pthread_setaffinity_np(thread, sizeof(set), &set);
+}
+#endif
+
+void pin_to_core(std::thread& thread, std::size_t core) {
+#if defined(__linux__)
+  pin_to_core(thread.native_handle(), core);
+#else
+  (void)thread;
+  (void)core;
+#endif
+}
+
+}  // namespace
+
+struct ScopedCorePin::SavedAffinity {
+#if defined(__linux__)
+  cpu_set_t set;
+  bool valid{false};
+#endif
+};
+
+ScopedCorePin::ScopedCorePin(std::size_t core) : saved_(std::make_unique<SavedAffinity>()) {
+#if defined(__linux__)
+  saved_->valid =
+      pthread_getaffinity_np(pthread_self(), sizeof(saved_->set), &saved_->set) == 0;
+  pin_to_core(pthread_self(), core);
+#else
+  (void)core;
+#endif
+}
+
+ScopedCorePin::~ScopedCorePin() {
+#if defined(__linux__)
+  if (saved_->valid) {
+    pthread_setaffinity_np(pthread_self(), sizeof(saved_->set), &saved_->set);
+  }
+#endif
+}
+
+BookManager::BookManager(std::size_t shard_count, std::size_t ingress_capacity, bool pin_threads) {
+  if (shard_count == 0) {
+    shard_count = 1;
+  }
+  shards_.reserve(shard_count);
+  for (std::size_t i = 0; i < shard_count; ++i) {
+    shards_.push_back(std::make_unique<Shard>(ingress_capacity));
+  }
+  for (std::size_t i = 0; i < shard_count; ++i) {
+    Shard& shard = *shards_[i];
+    shard.worker = std::thread([this, &shard] { run_shard(shard); });
+    if (pin_threads) {
+      pin_to_core(shard.worker, i);
+    }
+  }
+}
+
+BookManager::~BookManager() {
+  running_.store(false, std::memory_order_release);
+  for (auto& shard : shards_) {
+    if (shard->worker.joinable()) {
+      shard->worker.join();
+    }
+  }
+}
+
+std::size_t BookManager::producer_core() const {
+  return shards_.size() % core_count();
+}
+
+std::size_t BookManager::shard_for(std::uint32_t symbol) const {
+  return absl::Hash<std::uint32_t>{}(symbol) % shards_.size();
+}
+
+void BookManager::submit(const BookEvent& event) {
+  Shard& shard = *shards_[shard_for(event.symbol)];
+  while (!shard.ingress.try_push(event)) {
+    std::this_thread::yield();
+  }
+  ++shard.submitted;
+}
+
+void BookManager::flush() {
+  for (auto& shard : shards_) {
+    while (shard->processed.load(std::memory_order_acquire) != shard->submitted) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+std::uint64_t BookManager::processed() const {
+  std::uint64_t total = 0;
+  for (const auto& shard : shards_) {
+    total += shard->processed.load(std::memory_order_acquire);
+  }
+  return total;
+}
+
+std::size_t BookManager::total_orders() const {
+  std::size_t total = 0;
+  for (const auto& shard : shards_) {
+    for (const auto& [symbol, book] : shard->books) {
+      total += book.size();
+    }
+  }
+  return total;
+}
+
+void BookManager::run_shard(Shard& shard) {
+  // Drain in batches so the consumer releases ring slots and publishes progress once per run.
+  constexpr std::size_t kDrainBatch = 64;
+  BookEvent events[kDrainBatch];
+  for (;;) {
+    const std::size_t popped = shard.ingress.try_pop_batch(events);
+    if (popped == 0) {
+      if (!running_.load(std::memory_order_acquire) && shard.ingress.empty()) {
+        return;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+    for (std::size_t i = 0; i < popped; ++i) {
+      const BookEvent& event = events[i];
+      auto it = shard.books.find(event.symbol);
+      if (it == shard.books.end()) {
+        it = shard.books.try_emplace(event.symbol).first;
+      }
+      InstrumentBook& book = it->second;
+      switch (event.kind) {
+        case BookEvent::Kind::Add:
+          book.push_back(event.order);
+          break;
+        case BookEvent::Kind::Cancel:
+          book.erase_by_id(event.order.id);
+          break;
+        case BookEvent::Kind::Execute:
+          if (!book.empty()) {
+            book.pop_front();
+          }
+          break;
+      }
+    }
+    shard.processed.fetch_add(popped, std::memory_order_release);
+  }
+}
+
+std::vector<BookEvent> make_book_stream(std::size_t symbols,
+                                        std::size_t count,
+                                        std::uint64_t seed) {
+  constexpr std::size_t kTargetDepth = 32;
+  std::vector<BookEvent> events;
+  events.reserve(count);
+  if (symbols == 0) {
+    return events;
+  }
+  OrderGenerator generator(seed);
+  std::mt19937_64 rng(seed ^ 0x9e37'79b9'7f4a'7c15ull);
+  std::uniform_int_distribution<std::size_t> symbol_dist(0, symbols - 1);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<std::vector<std::uint64_t>> live(symbols);
+
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::size_t symbol = symbol_dist(rng);
+    auto& ids = live[symbol];
+    BookEvent event;
+    event.symbol = static_cast<std::uint32_t>(symbol);
+    // Bias toward adds below the target depth so every book hovers around it.
+    const double add_probability = ids.size() < kTargetDepth ? 0.6 : 0.4;
+    if (ids.empty() || unit(rng) < add_probability) {
+      event.kind = BookEvent::Kind::Add;
+      event.order = generator.next_order();
+      ids.push_back(event.order.id);
+    } else if (unit(rng) < 0.6) {
+      event.kind = BookEvent::Kind::Cancel;
+      const std::size_t idx = static_cast<std::size_t>(rng() % ids.size());
+      event.order.id = ids[idx];
+      ids.erase(ids.begin() + static_cast<std::ptrdiff_t>(idx));
+    } else {
+      event.kind = BookEvent::Kind::Execute;
+      event.order.id = ids.front();
+      ids.erase(ids.begin());
+    }
+    events.push_back(event);
+  }
+  return events;
+}
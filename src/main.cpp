@@ -2,28 +2,73 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <iterator>
+#include <latch>
+#include <memory>
+#include <memory_resource>
+#include <optional>
 #include <random>
+#include <span>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include <absl/container/flat_hash_set.h>
 
+#include "arena_allocator.hpp"
+#include "batch_search.hpp"
 #include "block_level.hpp"
+#include "compact_order.hpp"
+#include "book_manager.hpp"
+#include "cumulative_vec_deque.hpp"
+#include "galloping_search.hpp"
+#include "hot_cold_split.hpp"
+#include "id_search.hpp"
+#include "interpolation_search.hpp"
+#include "mirrored_allocator.hpp"
 #include "order.hpp"
+#include "order_codec.hpp"
+#include "order_flow.hpp"
 #include "order_generator.hpp"
+#include "pgm_index.hpp"
+#include "s_tree.hpp"
+#include "spsc_queue.hpp"
 #include "vec_deque.hpp"
 
 namespace {
 
 using OrderVolumeBreakdown = VolumeBreakdown<Order>;
+using MirroredOrderDeque = VecDeque<Order, MirroredAllocator<Order>>;
+using CumulativeOrderDeque = CumulativeVecDeque<Order>;
+// Finger-cached variants: remember the last kFingerSlots ids they resolved.
+constexpr std::size_t kFingerSlots = 8;
+using FingerOrderDeque = VecDeque<Order, std::allocator<Order>, 0, kFingerSlots>;
+using FingerVolumeBreakdown = VolumeBreakdown<Order, 64, std::allocator<Order>, kFingerSlots>;
+// 12-byte orders stored as offsets from a CompactOrderBase covering the generated book.
+using CompactOrderVector = std::vector<CompactOrder>;
+using CompactOrderDeque = VecDeque<CompactOrder>;
+using CompactVolumeBreakdown = VolumeBreakdown<CompactOrder>;
+
+// 16-byte {id, volume} halves in the usual containers, the other fields in a cold side array.
+using HotColdVector = HotColdSplit<std::vector<HotOrder>>;
+using HotColdVecDeque = HotColdSplit<VecDeque<HotOrder>>;
+using HotColdVolumeBreakdown = HotColdSplit<VolumeBreakdown<HotOrder>>;
+
+// Containers that answer cumulative-volume ranges themselves instead of a linear running sum.
+template <typename Container>
+constexpr bool kHasVolumeRange = std::is_same_v<Container, OrderVolumeBreakdown> ||
+                                 std::is_same_v<Container, CumulativeOrderDeque> ||
+                                 std::is_same_v<Container, HotColdVolumeBreakdown>;
 
 constexpr std::array<std::size_t, 7> kSizes{10, 50, 100, 500, 1000, 10'000, 100'000};
+// Read-mostly snapshots of large queues, for the S-tree engines.
+constexpr std::array<std::size_t, 4> kLargeSizes{10'000, 100'000, 1'000'000, 10'000'000};
 constexpr std::size_t kQueryCount = 4'096;
 constexpr double kHitRatio = 0.5;
 
@@ -60,6 +105,95 @@ VecDeque<Order> make_container(const std::vector<Order>& orders) {
   return out;
 }
 
+// Packs `orders` against a base covering all of them. The compact containers skip apply_churn
+// (the generic no-op), since churn ids restart below the base; compare them with the Order
+// books registered with `churn = false`.
+template <typename Container>
+Container make_compact_container(const std::vector<Order>& orders) {
+  const auto base = CompactOrderBase::covering(orders);
+  Container out;
+  for (const auto& order : orders) {
+    out.push_back(base.pack(order));
+  }
+  return out;
+}
+
+template <>
+CompactOrderVector make_container(const std::vector<Order>& orders) {
+  return make_compact_container<CompactOrderVector>(orders);
+}
+
+template <>
+CompactOrderDeque make_container(const std::vector<Order>& orders) {
+  return make_compact_container<CompactOrderDeque>(orders);
+}
+
+template <>
+CompactVolumeBreakdown make_container(const std::vector<Order>& orders) {
+  return make_compact_container<CompactVolumeBreakdown>(orders);
+}
+
+// Fills a hot/cold split; the splits churn like the containers they wrap.
+template <typename Container>
+Container make_hot_cold_container(const std::vector<Order>& orders) {
+  Container out;
+  for (const auto& order : orders) {
+    out.push_back(order);
+  }
+  return out;
+}
+
+template <>
+HotColdVector make_container(const std::vector<Order>& orders) {
+  return make_hot_cold_container<HotColdVector>(orders);
+}
+
+template <>
+HotColdVecDeque make_container(const std::vector<Order>& orders) {
+  return make_hot_cold_container<HotColdVecDeque>(orders);
+}
+
+template <>
+HotColdVolumeBreakdown make_container(const std::vector<Order>& orders) {
+  return make_hot_cold_container<HotColdVolumeBreakdown>(orders);
+}
+
+template <>
+FingerOrderDeque make_container(const std::vector<Order>& orders) {
+  FingerOrderDeque out;
+  for (const auto& order : orders) {
+    out.push_back(order);
+  }
+  return out;
+}
+
+template <>
+FingerVolumeBreakdown make_container(const std::vector<Order>& orders) {
+  FingerVolumeBreakdown out;
+  for (const auto& order : orders) {
+    out.push_back(order);
+  }
+  return out;
+}
+
+template <>
+MirroredOrderDeque make_container(const std::vector<Order>& orders) {
+  MirroredOrderDeque out;
+  for (const auto& order : orders) {
+    out.push_back(order);
+  }
+  return out;
+}
+
+template <>
+CumulativeOrderDeque make_container(const std::vector<Order>& orders) {
+  CumulativeOrderDeque out;
+  for (const auto& order : orders) {
+    out.push_back(order);
+  }
+  return out;
+}
+
 template <>
 OrderVolumeBreakdown make_container(const std::vector<Order>& orders) {
   OrderVolumeBreakdown out;
@@ -113,6 +247,28 @@ void apply_churn(VecDeque<Order>& container, OrderGenerator& generator, std::siz
   }
 }
 
+template <>
+void apply_churn(MirroredOrderDeque& container, OrderGenerator& generator, std::size_t operations) {
+  if (container.empty()) {
+    return;
+  }
+  for (std::size_t i = 0; i < operations; ++i) {
+    container.pop_front();
+    container.push_back(generator.next_order());
+  }
+}
+
+template <>
+void apply_churn(CumulativeOrderDeque& container, OrderGenerator& generator, std::size_t operations) {
+  if (container.empty()) {
+    return;
+  }
+  for (std::size_t i = 0; i < operations; ++i) {
+    container.pop_front();
+    container.push_back(generator.next_order());
+  }
+}
+
 template <>
 void apply_churn(OrderVolumeBreakdown& container, OrderGenerator& generator, std::size_t operations) {
   if (container.empty()) {
@@ -124,11 +280,58 @@ void apply_churn(OrderVolumeBreakdown& container, OrderGenerator& generator, std
   }
 }
 
+template <>
+void apply_churn(HotColdVector& container, OrderGenerator& generator, std::size_t operations) {
+  if (container.empty()) {
+    return;
+  }
+  operations = std::min(operations, container.size());
+  container.erase(container.begin(), container.begin() + static_cast<std::ptrdiff_t>(operations));
+  for (std::size_t i = 0; i < operations; ++i) {
+    container.push_back(generator.next_order());
+  }
+}
+
+template <>
+void apply_churn(HotColdVecDeque& container, OrderGenerator& generator, std::size_t operations) {
+  if (container.empty()) {
+    return;
+  }
+  for (std::size_t i = 0; i < operations; ++i) {
+    container.pop_front();
+    container.push_back(generator.next_order());
+  }
+}
+
+template <>
+void apply_churn(HotColdVolumeBreakdown& container,
+                 OrderGenerator& generator,
+                 std::size_t operations) {
+  if (container.empty()) {
+    return;
+  }
+  for (std::size_t i = 0; i < operations; ++i) {
+    container.pop_front();
+    container.push_back(generator.next_order());
+  }
+}
+
+// Whole orders of `container`: hot/cold splits join their halves, other containers already
+// hold Orders.
+template <typename Container>
+decltype(auto) whole_orders(const Container& container) {
+  if constexpr (requires { container.orders(); }) {
+    return container.orders();
+  } else {
+    return (container);
+  }
+}
+
 template <typename Container>
 auto find_order_iterator(Container& container, std::uint64_t id) {
   return std::lower_bound(
       container.begin(), container.end(), id,
-      [](const Order& lhs, std::uint64_t rhs) { return lhs.id < rhs; });
+      [](const auto& lhs, std::uint64_t rhs) { return lhs.id < rhs; });
 }
 
 template <typename Container>
@@ -146,57 +349,372 @@ bool erase_order(OrderVolumeBreakdown& container, std::uint64_t id) {
   return container.erase_by_id(id);
 }
 
+template <>
+bool erase_order(HotColdVolumeBreakdown& container, std::uint64_t id) {
+  return container.erase_by_id(id);
+}
+
+// The container's ids as Orders sorted by id, which make_query_ids needs for its near misses
+// to be absent: a churned book is not in id order, and compact books hold id offsets.
+template <typename Container>
+std::vector<Order> sorted_ids(const Container& container) {
+  std::vector<Order> ids;
+  ids.reserve(container.size());
+  for (const auto& element : container) {
+    Order order{};
+    order.id = element.id;
+    ids.push_back(order);
+  }
+  std::ranges::stable_sort(ids, {}, &Order::id);
+  return ids;
+}
+
+// `churn = false` leaves the book as generated, matching the compact books, which cannot churn.
 template <typename Container, typename Search>
-void RunBenchmark(benchmark::State& state, Search search) {
+void RunBenchmark(benchmark::State& state, Search search, bool churn) {
   const std::size_t size = static_cast<std::size_t>(state.range(0));
   OrderGenerator generator(123);
   auto orders = generator.generate(size);
 
   Container container = make_container<Container>(orders);
 
-  OrderGenerator churn_generator(10'000 + size);
-  apply_churn(container, churn_generator, churn_ops_for_size(size));
+  if (churn) {
+    OrderGenerator churn_generator(10'000 + size);
+    apply_churn(container, churn_generator, churn_ops_for_size(size));
+  }
 
-  std::vector<Order> snapshot(container.begin(), container.end());
+  std::mt19937_64 query_rng(111 * size + 7);
+  const auto queries = make_query_ids(sorted_ids(container), kQueryCount, kHitRatio, query_rng);
   std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
 
-  std::mt19937_64 query_rng(111 * size + 7);
-  std::uniform_int_distribution<std::size_t> index_dist;
-  if (!snapshot.empty()) {
-    index_dist = std::uniform_int_distribution<std::size_t>(0, snapshot.size() - 1);
+  std::size_t next = 0;
+  for (auto _ : state) {
+    const std::uint64_t id = queries.empty() ? 0 : queries[next];
+    next = queries.empty() ? 0 : (next + 1) % queries.size();
+
+    ThrashCache(cache_buffer);
+    const auto start = Clock::now();
+    auto it = search(container, id);
+    benchmark::DoNotOptimize(it);
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
   }
 
+  state.SetItemsProcessed(state.iterations());
+  state.SetComplexityN(static_cast<long>(size));
+}
+
+// A strategy's own orders, looked up over and over with a Zipf skew.
+constexpr std::size_t kZipfWorkingSet = 64;
+constexpr double kZipfExponent = 1.1;
+
+// Times the whole Zipf query set through find/find_by_id after one cache thrash per pass, and
+// reports the share of lookups the finger cache answered (zero for uncached containers).
+template <typename Container>
+void RunFingerBenchmark(benchmark::State& state) {
+  const std::size_t size = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(123);
+  const auto orders = generator.generate(size);
+  Container container = make_container<Container>(orders);
+
+  std::mt19937_64 query_rng(111 * size + 7);
+  const auto queries =
+      make_zipf_query_ids(orders, kQueryCount, kZipfWorkingSet, kZipfExponent, query_rng);
+  std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
+
   for (auto _ : state) {
-    const bool want_hit = (query_rng() & 1u) == 0;
-    std::uint64_t id = static_cast<std::uint64_t>(query_rng());
-    if (want_hit && !snapshot.empty()) {
-      id = snapshot[index_dist(query_rng)].id;
-    } else {
-      id ^= 0x5bd1'0000'0000'0000ull;
+    ThrashCache(cache_buffer);
+    std::int64_t checksum = 0;
+    const auto start = Clock::now();
+    for (const auto id : queries) {
+      if constexpr (requires { container.find_by_id(id); }) {
+        checksum += container.find_by_id(id)->volume;
+      } else {
+        checksum += container.find(id)->volume;
+      }
     }
+    benchmark::DoNotOptimize(checksum);
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+  const auto& fingers = container.finger_cache();
+  state.counters["hit_rate"] =
+      fingers.lookups() == 0 ? 0.0
+                             : static_cast<double>(fingers.hits()) /
+                                   static_cast<double>(fingers.lookups());
+}
+
+// Query distributions for RunQueryBenchmark; "Uniform" matches RunBenchmark's mix on an
+// unchurned book, and "AboveRange" keeps the old misses past the newest id for comparison.
+using Pick = QueryDistribution::Pick;
+using Miss = QueryDistribution::Miss;
+const std::array<std::pair<const char*, QueryDistribution>, 6> kQueryDistributions{{
+    {"Uniform", {.pick = Pick::Uniform, .hit_ratio = kHitRatio}},
+    {"AboveRange", {.pick = Pick::Uniform, .miss = Miss::AboveRange, .hit_ratio = kHitRatio}},
+    {"PositionZipf", {.pick = Pick::PositionZipf, .hit_ratio = kHitRatio}},
+    {"Recent", {.pick = Pick::Recent, .hit_ratio = kHitRatio}},
+    {"Own", {.pick = Pick::Own, .hit_ratio = kHitRatio}},
+    {"OwnHits", {.pick = Pick::Own, .hit_ratio = 1.0}},
+}};
+
+// Like RunBenchmark, but the queries come from make_query_ids with `distribution`. The book is
+// left unchurned, keeping it sorted with its newest orders at the back.
+template <typename Container, typename Search>
+void RunQueryBenchmark(benchmark::State& state,
+                       Search search,
+                       const QueryDistribution& distribution) {
+  const std::size_t size = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(123);
+  const auto orders = generator.generate(size);
+  Container container = make_container<Container>(orders);
 
+  std::mt19937_64 query_rng(111 * size + 7);
+  const auto queries = make_query_ids(orders, kQueryCount, distribution, query_rng);
+  std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
+
+  std::size_t next = 0;
+  for (auto _ : state) {
     ThrashCache(cache_buffer);
     const auto start = Clock::now();
-    auto it = search(container, id);
+    auto it = search(container, queries[next]);
     benchmark::DoNotOptimize(it);
     const auto end = Clock::now();
     state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    next = (next + 1) % queries.size();
   }
 
   state.SetItemsProcessed(state.iterations());
   state.SetComplexityN(static_cast<long>(size));
 }
 
+// Cold mode thrashes the cache before every single timed query, like RunBenchmark; warm mode
+// times the whole shared query set back to back so the structure stays resident. Engines that
+// report their footprint get an `index_bytes` counter.
+template <typename Engine>
+void TimeIdSearch(benchmark::State& state,
+                  const Engine& engine,
+                  const std::vector<std::uint64_t>& queries,
+                  bool cold) {
+  std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
+  std::size_t next = 0;
+  for (auto _ : state) {
+    if (cold) {
+      ThrashCache(cache_buffer);
+      const auto start = Clock::now();
+      auto idx = engine.lower_bound(queries[next]);
+      benchmark::DoNotOptimize(idx);
+      const auto end = Clock::now();
+      state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+      next = (next + 1) % queries.size();
+    } else {
+      std::size_t checksum = 0;
+      const auto start = Clock::now();
+      for (const auto id : queries) {
+        checksum += engine.lower_bound(id);
+      }
+      benchmark::DoNotOptimize(checksum);
+      const auto end = Clock::now();
+      state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+  }
+
+  const std::int64_t per_iteration = cold ? 1 : static_cast<std::int64_t>(queries.size());
+  state.SetItemsProcessed(state.iterations() * per_iteration);
+  state.SetComplexityN(static_cast<long>(engine.size()));
+  if constexpr (requires { engine.memory_bytes(); }) {
+    state.counters["index_bytes"] = static_cast<double>(engine.memory_bytes());
+  }
+}
+
+// PgmIdIndex as an id-search engine over the orders it was built from; its footprint is the
+// segments alone, since lookups finish in the orders themselves.
+class PgmIdSearch {
+ public:
+  explicit PgmIdSearch(std::span<const Order> orders) : orders_(orders), index_(orders) {}
+
+  std::size_t size() const { return orders_.size(); }
+  std::size_t memory_bytes() const { return index_.memory_bytes(); }
+
+  std::size_t lower_bound(std::uint64_t id) const {
+    return static_cast<std::size_t>(index_.lower_bound(orders_.begin(), orders_.end(), id) -
+                                    orders_.begin());
+  }
+
+ private:
+  std::span<const Order> orders_;
+  PgmIdIndex<> index_;
+};
+
+// The churned Vector book, sorted by id. Churn ids restart below the book's, so the churned
+// queue is not in id order; the static engines need it sorted before they can index it.
+std::vector<Order> make_sorted_churned_orders(std::size_t size) {
+  OrderGenerator generator(123);
+  auto container = make_container<std::vector<Order>>(generator.generate(size));
+  OrderGenerator churn_generator(10'000 + size);
+  apply_churn(container, churn_generator, churn_ops_for_size(size));
+  std::ranges::stable_sort(container, {}, &Order::id);
+  return container;
+}
+
+// Static id-search engines from id_search.hpp, built from the sorted churned Vector book.
+template <typename Engine>
+void RunIdSearchBenchmark(benchmark::State& state, bool cold) {
+  const std::size_t size = static_cast<std::size_t>(state.range(0));
+  const auto container = make_sorted_churned_orders(size);
+  const Engine engine{std::span<const Order>(container)};
+
+  std::mt19937_64 query_rng(111 * size + 7);
+  const auto queries = make_query_ids(container, kQueryCount, kHitRatio, query_rng);
+  TimeIdSearch(state, engine, queries, cold);
+}
+
+// Same timing as RunIdSearchBenchmark, but over the sorted, unchurned orders, so engines that
+// rely on the ids being sorted (the learned index) can be compared with the rest.
+template <typename Engine>
+void RunIdIndexBenchmark(benchmark::State& state, bool cold) {
+  const std::size_t size = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(123);
+  const auto orders = generator.generate(size);
+  const Engine engine{std::span<const Order>(orders)};
+
+  std::mt19937_64 query_rng(111 * size + 7);
+  const auto queries = make_query_ids(orders, kQueryCount, kHitRatio, query_rng);
+  TimeIdSearch(state, engine, queries, cold);
+}
+
+// Runs the shared query set through `STreeIdSearch::lower_bound_many` with `range(0)` lookups
+// in flight per group, after thrashing the cache once per pass.
+template <std::size_t NodeKeys>
+void RunSTreeBatchBenchmark(benchmark::State& state, std::size_t size) {
+  const std::size_t batch = static_cast<std::size_t>(state.range(0));
+  const auto container = make_sorted_churned_orders(size);
+  const STreeIdSearch<NodeKeys> tree{std::span<const Order>(container)};
+
+  std::mt19937_64 query_rng(111 * size + 7);
+  const auto queries = make_query_ids(container, kQueryCount, kHitRatio, query_rng);
+  std::vector<std::size_t> results(queries.size());
+  std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
+
+  for (auto _ : state) {
+    ThrashCache(cache_buffer);
+    const auto start = Clock::now();
+    tree.lower_bound_many(queries, results, batch);
+    benchmark::DoNotOptimize(results.data());
+    benchmark::ClobberMemory();
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+}
+
+// Keeps an S-tree in step with a churning VecDeque: each pass times kSTreeChurnOps rounds of
+// pop_front + push_back + one lookup of an id that stays live for the whole pass, so the
+// tree's tail searches and amortised rebuilds are included.
+constexpr std::size_t kSTreeChurnOps = 1'024;
+
+template <std::size_t NodeKeys>
+void RunSTreeChurnBenchmark(benchmark::State& state) {
+  const std::size_t size = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(123);
+  auto container = make_container<VecDeque<Order>>(generator.generate(size));
+  STreeIdSearch<NodeKeys> tree{container};
+
+  std::mt19937_64 rng(111 * size + 7);
+  std::vector<std::uint64_t> pushed(kSTreeChurnOps);
+  std::vector<std::uint64_t> queries(kSTreeChurnOps);
+
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kSTreeChurnOps; ++i) {
+      const Order order = generator.next_order();
+      pushed[i] = order.id;
+      container.pop_front();
+      container.push_back(order);
+    }
+    for (auto& id : queries) {
+      id = container[kSTreeChurnOps + rng() % (size - kSTreeChurnOps)].id;
+    }
+    std::size_t checksum = 0;
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < kSTreeChurnOps; ++i) {
+      tree.pop_front();
+      tree.push_back(pushed[i]);
+      checksum += tree.lower_bound(queries[i]);
+    }
+    benchmark::DoNotOptimize(checksum);
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kSTreeChurnOps));
+}
+
+// Resolves the whole shared query set through the container's batched `find_many` with
+// `range(0)` lookups in flight per group, after thrashing the cache once per pass.
+template <typename Container>
+void RunFindManyBenchmark(benchmark::State& state, std::size_t size) {
+  const std::size_t batch = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(123);
+  auto orders = generator.generate(size);
+  Container container = make_container<Container>(orders);
+  OrderGenerator churn_generator(10'000 + size);
+  apply_churn(container, churn_generator, churn_ops_for_size(size));
+
+  std::mt19937_64 query_rng(111 * size + 7);
+  const auto queries = make_query_ids(sorted_ids(container), kQueryCount, kHitRatio, query_rng);
+  using Result = std::conditional_t<std::is_same_v<Container, OrderVolumeBreakdown>,
+                                    typename OrderVolumeBreakdown::const_iterator, std::size_t>;
+  std::vector<Result> results(queries.size());
+  std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
+
+  for (auto _ : state) {
+    ThrashCache(cache_buffer);
+    const auto start = Clock::now();
+    if constexpr (std::is_same_v<Container, std::vector<Order>>) {
+      find_many(std::span<const Order>(container), queries, results, batch);
+    } else {
+      container.find_many(queries, results, batch);
+    }
+    benchmark::DoNotOptimize(results.data());
+    benchmark::ClobberMemory();
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(queries.size()));
+}
+
 constexpr auto StdLowerBoundSearch = [](auto& container, std::uint64_t id) {
   return std::lower_bound(
       container.begin(), container.end(), id,
-      [](const Order& lhs, std::uint64_t rhs) { return lhs.id < rhs; });
+      [](const auto& lhs, std::uint64_t rhs) { return lhs.id < rhs; });
+};
+
+constexpr auto SliceLowerBoundSearch = [](auto& container, std::uint64_t id) {
+  return container.lower_bound_by_id(id);
 };
 
 constexpr auto VolumeBreakdownFindSearch = [](auto& container, std::uint64_t id) {
   return container.find(id);
 };
 
+constexpr auto InterpolationSearch = [](auto& container, std::uint64_t id) {
+  if constexpr (requires { container.interpolation_lower_bound_by_id(id); }) {
+    return container.interpolation_lower_bound_by_id(id);
+  } else {
+    return interpolation_lower_bound(container.begin(), container.end(), id,
+                                     [](const auto& order) -> std::uint64_t { return order.id; });
+  }
+};
+
+constexpr auto GallopSearch = [](auto& container, std::uint64_t id) {
+  if constexpr (requires { container.gallop_lower_bound_by_id(id); }) {
+    return container.gallop_lower_bound_by_id(id);
+  } else {
+    return gallop_lower_bound(container.begin(), container.end(), id,
+                              [](const auto& order) -> std::uint64_t { return order.id; });
+  }
+};
+
 std::pair<std::int64_t, std::int64_t> compute_sum_bounds(const std::vector<Order>& orders) {
   if (orders.empty()) {
     return {0, 0};
@@ -239,7 +757,8 @@ void RunRangeIterationBenchmark(benchmark::State& state, RangeSelector select_ra
 
   OrderGenerator churn_gen(50'000 + size);
   apply_churn(container, churn_gen, churn_ops_for_size(size));
-  auto bounds = compute_sum_bounds(std::vector<Order>(container.begin(), container.end()));
+  const auto& orders = whole_orders(container);
+  auto bounds = compute_sum_bounds(std::vector<Order>(orders.begin(), orders.end()));
 
   OrderGenerator replenish_gen(80'000 + size);
   std::vector<std::uint64_t> removal_ids;
@@ -265,7 +784,7 @@ void RunRangeIterationBenchmark(benchmark::State& state, RangeSelector select_ra
       }
     }
     const auto start = Clock::now();
-    auto range = select_range(static_cast<const Container&>(container), bounds.first, bounds.second);
+    auto range = select_range(container, bounds.first, bounds.second);
     std::int64_t volume_sum = 0;
     std::size_t count = 0;
     for (auto it = range.first; it != range.second; ++it) {
@@ -284,6 +803,64 @@ void RunRangeIterationBenchmark(benchmark::State& state, RangeSelector select_ra
   state.SetComplexityN(static_cast<long>(size));
 }
 
+// Sums every volume with a plain begin()/end() walk; isolates per-element iterator cost.
+// `churn` as in RunBenchmark.
+template <typename Container>
+void RunScanBenchmark(benchmark::State& state, bool churn) {
+  const std::size_t size = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(20'000 + size);
+  Container container = make_container<Container>(generator.generate(size));
+
+  if (churn) {
+    OrderGenerator churn_gen(30'000 + size);
+    apply_churn(container, churn_gen, churn_ops_for_size(size));
+  }
+
+  std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
+  for (auto _ : state) {
+    ThrashCache(cache_buffer);
+    const auto start = Clock::now();
+    const auto& view = static_cast<const Container&>(container);
+    std::int64_t volume_sum = 0;
+    for (auto it = view.begin(); it != view.end(); ++it) {
+      volume_sum += it->volume;
+    }
+    benchmark::DoNotOptimize(volume_sum);
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(container.size()));
+  state.SetComplexityN(static_cast<long>(size));
+}
+
+// Like RunScanBenchmark, but reads every field of each whole order, so hot/cold splits pay
+// for joining their halves.
+template <typename Container>
+void RunScanOrdersBenchmark(benchmark::State& state) {
+  const std::size_t size = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(20'000 + size);
+  Container container = make_container<Container>(generator.generate(size));
+
+  OrderGenerator churn_gen(30'000 + size);
+  apply_churn(container, churn_gen, churn_ops_for_size(size));
+
+  std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
+  for (auto _ : state) {
+    ThrashCache(cache_buffer);
+    const auto start = Clock::now();
+    std::uint64_t checksum = 0;
+    for (const Order& order : whole_orders(container)) {
+      checksum += order.exchangeTimestamp + static_cast<std::uint64_t>(order.volume) +
+                  (order.isOwn ? 1u : 0u);
+    }
+    benchmark::DoNotOptimize(checksum);
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(container.size()));
+  state.SetComplexityN(static_cast<long>(size));
+}
+
 template <typename Container, typename RangeSelector>
 void RunCumsumSliceRangeBenchmark(benchmark::State& state, std::size_t target_len, RangeSelector select_range) {
   const std::size_t size = static_cast<std::size_t>(state.range(0));
@@ -432,19 +1009,385 @@ void RunSteadyPushPopBenchmark(benchmark::State& state, bool time_push_back) {
   state.SetComplexityN(static_cast<long>(size));
 }
 
+struct StdAllocSetup {
+  using allocator_type = std::allocator<Order>;
+  allocator_type allocator() { return {}; }
+};
+
+struct PmrMonotonicSetup {
+  using allocator_type = std::pmr::polymorphic_allocator<Order>;
+  std::pmr::monotonic_buffer_resource resource;
+  allocator_type allocator() { return allocator_type(&resource); }
+};
+
+struct PmrPoolSetup {
+  using allocator_type = std::pmr::polymorphic_allocator<Order>;
+  std::pmr::unsynchronized_pool_resource resource;
+  allocator_type allocator() { return allocator_type(&resource); }
+};
+
+struct ArenaSetup {
+  using allocator_type = ArenaAllocator<Order>;
+  Arena arena;
+  allocator_type allocator() { return allocator_type(&arena); }
+};
+
+template <typename Allocator>
+using VecDequeLevel = VecDeque<Order, Allocator>;
+
+template <typename Allocator>
+using VolumeBreakdownLevel = VolumeBreakdown<Order, 64, Allocator>;
+
+constexpr std::array<std::size_t, 4> kLevelCounts{10, 100, 1000, 4000};
+constexpr std::size_t kOrdersPerLevel = 48;
+
+// Builds `levels` price levels that share one allocator, cycles every level through a full
+// replacement (push kOrdersPerLevel, pop kOrdersPerLevel) and tears the book down. Every
+// allocation and release made by the containers falls inside the timed region.
+template <typename Setup, template <typename> class Level>
+void RunAllocatorBookBenchmark(benchmark::State& state) {
+  const std::size_t levels = static_cast<std::size_t>(state.range(0));
+  const std::size_t order_count = levels * kOrdersPerLevel;
+  OrderGenerator generator(500 + levels);
+  auto orders = generator.generate(2 * order_count);
+
+  using LevelType = Level<typename Setup::allocator_type>;
+  std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
+  for (auto _ : state) {
+    ThrashCache(cache_buffer);
+    const auto start = Clock::now();
+    {
+      Setup setup;
+      std::vector<LevelType> book;
+      book.reserve(levels);
+      for (std::size_t level = 0; level < levels; ++level) {
+        auto& container = book.emplace_back(setup.allocator());
+        for (std::size_t i = 0; i < kOrdersPerLevel; ++i) {
+          container.push_back(orders[level * kOrdersPerLevel + i]);
+        }
+      }
+      std::int64_t volume = 0;
+      for (std::size_t level = 0; level < levels; ++level) {
+        auto& container = book[level];
+        for (std::size_t i = 0; i < kOrdersPerLevel; ++i) {
+          container.push_back(orders[order_count + level * kOrdersPerLevel + i]);
+        }
+        for (std::size_t i = 0; i < kOrdersPerLevel; ++i) {
+          container.pop_front();
+        }
+        volume += container.front().volume;
+      }
+      benchmark::DoNotOptimize(volume);
+    }
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(3 * order_count));
+  state.SetComplexityN(static_cast<long>(levels));
+}
+
+using InlineOrderDeque = VecDeque<Order, std::allocator<Order>, 16>;
+
+constexpr std::size_t kSmallLevelMaxOrders = 16;
+
+// Thousands of shallow levels (1..16 orders each): build the book, rotate one order through
+// every level and sum each level's volume. Dominated by per-level allocations and by the
+// pointer chase from the level object to its elements.
+template <typename Level>
+void RunSmallLevelBenchmark(benchmark::State& state) {
+  const std::size_t levels = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(900 + levels);
+  std::mt19937_64 depth_rng(950 + levels);
+  std::vector<std::size_t> depths(levels);
+  std::size_t order_count = 0;
+  for (auto& depth : depths) {
+    depth = 1 + static_cast<std::size_t>(depth_rng() % kSmallLevelMaxOrders);
+    order_count += depth;
+  }
+  auto orders = generator.generate(order_count + levels);
+
+  std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
+  for (auto _ : state) {
+    ThrashCache(cache_buffer);
+    const auto start = Clock::now();
+    {
+      std::vector<Level> book(levels);
+      std::size_t next = 0;
+      for (std::size_t level = 0; level < levels; ++level) {
+        for (std::size_t i = 0; i < depths[level]; ++i) {
+          book[level].push_back(orders[next++]);
+        }
+      }
+      std::int64_t volume = 0;
+      for (auto& level : book) {
+        level.pop_front();
+        level.push_back(orders[next++]);
+        for (const auto& order : level) {
+          volume += order.volume;
+        }
+      }
+      benchmark::DoNotOptimize(volume);
+    }
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(levels));
+  state.SetComplexityN(static_cast<long>(levels));
+}
+
+constexpr std::size_t kStreamSymbols = 4'096;
+constexpr std::size_t kStreamEvents = 1'000'000;
+
+const std::vector<BookEvent>& book_stream() {
+  static const std::vector<BookEvent> stream =
+      make_book_stream(kStreamSymbols, kStreamEvents, 2'024);
+  return stream;
+}
+
+// Replays the shared multi-symbol stream through a BookManager with `range(0)` shards, with
+// this (producer) thread pinned to the core the shards leave free. Thread start-up, pinning and
+// teardown happen outside the timed region; timing covers routing plus the shards draining
+// their ingress queues.
+void RunBookManagerBenchmark(benchmark::State& state) {
+  const std::size_t shards = static_cast<std::size_t>(state.range(0));
+  const auto& stream = book_stream();
+  for (auto _ : state) {
+    BookManager manager(shards);
+    const ScopedCorePin producer_pin(manager.producer_core());
+    const auto start = Clock::now();
+    for (const auto& event : stream) {
+      manager.submit(event);
+    }
+    manager.flush();
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    benchmark::DoNotOptimize(manager.total_orders());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(stream.size()));
+}
+
+enum class OrderStreamMode { Encode, Decode, RawCopy, LoadVecDeque };
+
+// One pass of the order codec over `range(0)` generated orders: encode them, decode the
+// stream into a preallocated buffer, copy the raw orders into that buffer (the cost of reading
+// an uncompressed snapshot), or bulk-load a VecDeque from the stream. Bytes processed are raw
+// Order bytes in every mode, so the rates compare directly.
+void RunOrderStreamBenchmark(benchmark::State& state, OrderStreamMode mode) {
+  const std::size_t size = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(123);
+  const auto orders = generator.generate(size);
+  const auto stream = encode_orders(orders);
+  std::vector<Order> out(size);
+
+  for (auto _ : state) {
+    const auto start = Clock::now();
+    switch (mode) {
+      case OrderStreamMode::Encode: {
+        const auto encoded = encode_orders(orders);
+        benchmark::DoNotOptimize(encoded.data());
+        break;
+      }
+      case OrderStreamMode::Decode: {
+        OrderStreamReader reader(stream);
+        reader.read(out);
+        break;
+      }
+      case OrderStreamMode::RawCopy:
+        std::copy(orders.begin(), orders.end(), out.begin());
+        break;
+      case OrderStreamMode::LoadVecDeque: {
+        VecDeque<Order> book;
+        load_orders(stream, book);
+        benchmark::DoNotOptimize(book.back());
+        break;
+      }
+    }
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(size * sizeof(Order)));
+  state.counters["bytes_per_order"] =
+      static_cast<double>(stream.size()) / static_cast<double>(size);
+}
+
+// Times OrderGenerator::generate for `range(0)` orders written by `range(1)` threads; the
+// orders are identical for every thread count.
+void RunGenerateBenchmark(benchmark::State& state) {
+  const std::size_t count = static_cast<std::size_t>(state.range(0));
+  const std::size_t threads = static_cast<std::size_t>(state.range(1));
+  for (auto _ : state) {
+    OrderGenerator generator(123);
+    const auto start = Clock::now();
+    const auto orders = generator.generate(count, threads);
+    benchmark::DoNotOptimize(orders.data());
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+
+// Order flow regimes for RunOrderFlowBenchmark, each at the default event mix: cancels and
+// modifies near the back under Poisson or bursty arrivals, or anywhere in the queue.
+using Arrival = OrderFlowConfig::Arrival;
+using Position = OrderFlowConfig::Position;
+const std::array<std::pair<const char*, OrderFlowConfig>, 3> kOrderFlowRegimes{{
+    {"Steady", {}},
+    {"Bursty", {.arrival = Arrival::Bursty}},
+    {"UniformCancel", {.cancel_position = Position::Uniform}},
+}};
+constexpr std::size_t kOrderFlowEvents = 1 << 16;
+
+// Replays one deterministic OrderFlowGenerator stream of kOrderFlowEvents events into a
+// container built from `range(0)` generated orders, with the queue held around that size.
+// Every container consumes the same events, and the queue stays sorted by id throughout.
+template <typename Container>
+void RunOrderFlowBenchmark(benchmark::State& state, const OrderFlowConfig& regime) {
+  const std::size_t size = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(123);
+  const auto orders = generator.generate(size);
+  OrderFlowConfig config = regime;
+  config.target_size = size;
+  OrderFlowGenerator flow(config, 10'000 + size, orders);
+  const auto events = flow.generate(kOrderFlowEvents);
+  std::vector<std::uint8_t> cache_buffer(kCacheThrashBytes, 0);
+
+  for (auto _ : state) {
+    Container container = make_container<Container>(orders);
+    ThrashCache(cache_buffer);
+    const auto start = Clock::now();
+    apply_order_flow(container, std::span<const OrderFlowEvent>(events));
+    benchmark::DoNotOptimize(container.size());
+    const auto end = Clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(events.size()));
+  state.counters["final_size"] = static_cast<double>(flow.size());
+}
+
+struct FeedMessage {
+  Order order;
+  std::int64_t publish_ns;
+};
+
+constexpr std::size_t kHandoffMessages = 1 << 18;
+constexpr std::size_t kHandoffQueueCapacity = 4'096;
+constexpr std::array<std::size_t, 4> kHandoffBatches{1, 8, 32, 128};
+
+std::int64_t steady_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+      .count();
+}
+
+// Feed-to-book handoff: the producer publishes generated orders in batches of `range(0)`,
+// stamping each batch just before the push; a consumer thread drains with the same batch
+// size and records per-message latency. Reports throughput plus latency percentiles over all
+// iterations.
+template <typename WaitStrategy>
+void RunSpscHandoffBenchmark(benchmark::State& state) {
+  const std::size_t batch = static_cast<std::size_t>(state.range(0));
+  OrderGenerator generator(1'300);
+  const auto orders = generator.generate(kHandoffMessages);
+  // The consumer writes each pass into a presized buffer; passes are merged into `latencies`
+  // between timed regions, so no allocation lands inside the measured handoff.
+  std::vector<std::int64_t> pass_latencies(kHandoffMessages);
+  std::vector<std::int64_t> latencies;
+
+  for (auto _ : state) {
+    SpscQueue<FeedMessage, WaitStrategy> queue(kHandoffQueueCapacity);
+    std::int64_t volume = 0;
+    std::latch ready(2);
+    std::atomic<bool> drained{false};
+    // The consumer thread is started and parked on `ready` before the clock starts.
+    std::thread consumer([&] {
+      std::vector<FeedMessage> out(batch);
+      ready.arrive_and_wait();
+      for (std::size_t received = 0; received < kHandoffMessages;) {
+        const std::size_t popped = queue.pop_batch(out);
+        const std::int64_t now = steady_ns();
+        for (std::size_t i = 0; i < popped; ++i) {
+          pass_latencies[received + i] = now - out[i].publish_ns;
+          volume += out[i].order.volume;
+        }
+        received += popped;
+      }
+      drained.store(true, std::memory_order_release);
+      drained.notify_one();
+    });
+    std::vector<FeedMessage> pending(batch);
+    ready.arrive_and_wait();
+    const auto start = Clock::now();
+    for (std::size_t next = 0; next < kHandoffMessages; next += batch) {
+      const std::size_t count = std::min(batch, kHandoffMessages - next);
+      const std::int64_t now = steady_ns();
+      for (std::size_t i = 0; i < count; ++i) {
+        pending[i] = FeedMessage{orders[next + i], now};
+      }
+      queue.push_batch(std::span<const FeedMessage>(pending.data(), count));
+    }
+    drained.wait(false, std::memory_order_acquire);
+    const auto end = Clock::now();
+    consumer.join();
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    benchmark::DoNotOptimize(volume);
+    latencies.insert(latencies.end(), pass_latencies.begin(), pass_latencies.end());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kHandoffMessages));
+
+  std::sort(latencies.begin(), latencies.end());
+  const auto percentile = [&](double p) {
+    if (latencies.empty()) {
+      return 0.0;
+    }
+    const auto idx = static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1));
+    return static_cast<double>(latencies[idx]);
+  };
+  state.counters["p50_ns"] = percentile(0.50);
+  state.counters["p99_ns"] = percentile(0.99);
+  state.counters["p999_ns"] = percentile(0.999);
+}
+
 template <typename Container, typename Search>
-void RegisterBenchmarks(const std::string& name, Search search) {
-  auto* bench = benchmark::RegisterBenchmark(name.c_str(),
-                                             [](benchmark::State& state, Search search_fn) {
-                                               RunBenchmark<Container>(state, search_fn);
-                                             },
-                                             search);
+void RegisterBenchmarks(const std::string& name, Search search, bool churn = true) {
+  auto* bench = benchmark::RegisterBenchmark(
+      name.c_str(),
+      [churn](benchmark::State& state, Search search_fn) {
+        RunBenchmark<Container>(state, search_fn, churn);
+      },
+      search);
   bench->UseManualTime();
   for (auto size : kSizes) {
     bench->Arg(static_cast<int>(size));
   }
 }
 
+template <typename Container>
+void RegisterFingerBenchmarks(const std::string& name) {
+  auto* bench =
+      benchmark::RegisterBenchmark((name + "/Zipf").c_str(), RunFingerBenchmark<Container>);
+  bench->UseManualTime();
+  for (auto size : kSizes) {
+    bench->Arg(static_cast<int>(size));
+  }
+}
+
+template <typename Container, typename Search>
+void RegisterQueryBenchmarks(const std::string& name, Search search) {
+  for (const auto& [suffix, distribution] : kQueryDistributions) {
+    auto* bench = benchmark::RegisterBenchmark(
+        (name + "/" + suffix).c_str(),
+        [](benchmark::State& state, Search search_fn, QueryDistribution queries) {
+          RunQueryBenchmark<Container>(state, search_fn, queries);
+        },
+        search, distribution);
+    bench->UseManualTime();
+    for (auto size : kSizes) {
+      bench->Arg(static_cast<int>(size));
+    }
+  }
+}
+
 template <typename Container>
 void RegisterBulkCopyBenchmarks(const std::string& prefix) {
   auto scalar = benchmark::RegisterBenchmark(
@@ -533,6 +1476,188 @@ void RegisterSteadyPushPopBenchmarks(const std::string& prefix) {
   }
 }
 
+template <template <typename> class Level>
+void RegisterAllocatorBenchmarks(const std::string& prefix) {
+  std::array<benchmark::internal::Benchmark*, 4> benches{
+      benchmark::RegisterBenchmark((prefix + "/Alloc/Std").c_str(),
+                                   RunAllocatorBookBenchmark<StdAllocSetup, Level>),
+      benchmark::RegisterBenchmark((prefix + "/Alloc/PmrMonotonic").c_str(),
+                                   RunAllocatorBookBenchmark<PmrMonotonicSetup, Level>),
+      benchmark::RegisterBenchmark((prefix + "/Alloc/PmrPool").c_str(),
+                                   RunAllocatorBookBenchmark<PmrPoolSetup, Level>),
+      benchmark::RegisterBenchmark((prefix + "/Alloc/Arena").c_str(),
+                                   RunAllocatorBookBenchmark<ArenaSetup, Level>),
+  };
+  for (auto* bench : benches) {
+    bench->UseManualTime();
+    for (auto levels : kLevelCounts) {
+      bench->Arg(static_cast<int>(levels));
+    }
+  }
+}
+
+template <typename Level>
+void RegisterSmallLevelBenchmarks(const std::string& name) {
+  auto* bench = benchmark::RegisterBenchmark(name.c_str(), RunSmallLevelBenchmark<Level>);
+  bench->UseManualTime();
+  for (auto levels : kLevelCounts) {
+    bench->Arg(static_cast<int>(levels));
+  }
+}
+
+void RegisterBookManagerBenchmarks(const std::string& name) {
+  auto* bench = benchmark::RegisterBenchmark(name.c_str(), RunBookManagerBenchmark);
+  bench->UseManualTime();
+  // One core stays free for the producer.
+  const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t max_shards = std::max<std::size_t>(1, cores - 1);
+  for (std::size_t shards = 1; shards < max_shards; shards *= 2) {
+    bench->Arg(static_cast<int>(shards));
+  }
+  bench->Arg(static_cast<int>(max_shards));
+}
+
+void RegisterOrderStreamBenchmarks() {
+  const std::array<std::pair<const char*, OrderStreamMode>, 4> modes{{
+      {"OrderStream/Encode", OrderStreamMode::Encode},
+      {"OrderStream/Decode", OrderStreamMode::Decode},
+      {"OrderStream/RawCopy", OrderStreamMode::RawCopy},
+      {"OrderStream/LoadVecDeque", OrderStreamMode::LoadVecDeque},
+  }};
+  for (const auto& [name, mode] : modes) {
+    auto* bench = benchmark::RegisterBenchmark(
+        name, [mode](benchmark::State& state) { RunOrderStreamBenchmark(state, mode); });
+    bench->UseManualTime();
+    for (auto size : kLargeSizes) {
+      bench->Arg(static_cast<int>(size));
+    }
+  }
+}
+
+void RegisterGenerateBenchmarks(const std::string& name) {
+  auto* bench = benchmark::RegisterBenchmark(name.c_str(), RunGenerateBenchmark);
+  bench->UseManualTime();
+  const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  for (const std::size_t count : {1'000'000, 10'000'000}) {
+    for (std::size_t threads = 1; threads < cores; threads *= 2) {
+      bench->Args({static_cast<int>(count), static_cast<int>(threads)});
+    }
+    bench->Args({static_cast<int>(count), static_cast<int>(cores)});
+  }
+}
+
+template <typename Container>
+void RegisterOrderFlowBenchmarks(const std::string& name) {
+  for (const auto& [regime_name, regime] : kOrderFlowRegimes) {
+    auto* bench = benchmark::RegisterBenchmark(
+        (name + "/OrderFlow/" + regime_name).c_str(),
+        [](benchmark::State& state, OrderFlowConfig config) {
+          RunOrderFlowBenchmark<Container>(state, config);
+        },
+        regime);
+    bench->UseManualTime();
+    for (auto size : kSizes) {
+      bench->Arg(static_cast<int>(size));
+    }
+  }
+}
+
+template <typename WaitStrategy>
+void RegisterSpscHandoffBenchmarks(const std::string& name) {
+  auto* bench = benchmark::RegisterBenchmark(name.c_str(), RunSpscHandoffBenchmark<WaitStrategy>);
+  bench->UseManualTime();
+  for (auto batch : kHandoffBatches) {
+    bench->Arg(static_cast<int>(batch));
+  }
+}
+
+constexpr std::array<std::size_t, 2> kFindManySizes{1'000, 100'000};
+constexpr std::array<std::size_t, 6> kFindManyBatches{1, 2, 4, 8, 16, 32};
+
+template <typename Engine>
+void RegisterIdSearchBenchmarks(const std::string& prefix,
+                                std::span<const std::size_t> sizes = kSizes) {
+  for (const bool cold : {true, false}) {
+    const std::string name = prefix + (cold ? "/Cold" : "/Warm");
+    auto* bench = benchmark::RegisterBenchmark(
+        name.c_str(),
+        [cold](benchmark::State& state) { RunIdSearchBenchmark<Engine>(state, cold); });
+    bench->UseManualTime();
+    for (auto size : sizes) {
+      bench->Arg(static_cast<int>(size));
+    }
+  }
+}
+
+template <typename Engine>
+void RegisterIdIndexBenchmarks(const std::string& name) {
+  for (const bool cold : {true, false}) {
+    const std::string full_name = "Vector/IdIndex/" + name + (cold ? "/Cold" : "/Warm");
+    auto* bench = benchmark::RegisterBenchmark(
+        full_name.c_str(),
+        [cold](benchmark::State& state) { RunIdIndexBenchmark<Engine>(state, cold); });
+    bench->UseManualTime();
+    for (auto size : kLargeSizes) {
+      bench->Arg(static_cast<int>(size));
+    }
+  }
+}
+
+template <std::size_t NodeKeys>
+void RegisterSTreeBenchmarks(const std::string& prefix) {
+  RegisterIdSearchBenchmarks<STreeIdSearch<NodeKeys>>("Vector/" + prefix, kLargeSizes);
+  for (auto size : kLargeSizes) {
+    const std::string name = "Vector/" + prefix + "/Batch/" + std::to_string(size);
+    auto* bench = benchmark::RegisterBenchmark(
+        name.c_str(),
+        [size](benchmark::State& state) { RunSTreeBatchBenchmark<NodeKeys>(state, size); });
+    bench->UseManualTime();
+    for (auto batch : kFindManyBatches) {
+      bench->Arg(static_cast<int>(batch));
+    }
+  }
+  auto* churn = benchmark::RegisterBenchmark(("VecDeque/" + prefix + "/Churn").c_str(),
+                                             RunSTreeChurnBenchmark<NodeKeys>);
+  churn->UseManualTime();
+  for (auto size : kLargeSizes) {
+    churn->Arg(static_cast<int>(size));
+  }
+}
+
+template <typename Container>
+void RegisterFindManyBenchmarks(const std::string& prefix) {
+  for (auto size : kFindManySizes) {
+    const std::string name = prefix + "/FindMany/" + std::to_string(size);
+    auto* bench = benchmark::RegisterBenchmark(
+        name.c_str(),
+        [size](benchmark::State& state) { RunFindManyBenchmark<Container>(state, size); });
+    bench->UseManualTime();
+    for (auto batch : kFindManyBatches) {
+      bench->Arg(static_cast<int>(batch));
+    }
+  }
+}
+
+template <typename Container>
+void RegisterScanBenchmarks(const std::string& name, bool churn = true) {
+  auto* bench = benchmark::RegisterBenchmark(name.c_str(), [churn](benchmark::State& state) {
+    RunScanBenchmark<Container>(state, churn);
+  });
+  bench->UseManualTime();
+  for (auto size : kSizes) {
+    bench->Arg(static_cast<int>(size));
+  }
+}
+
+template <typename Container>
+void RegisterScanOrdersBenchmarks(const std::string& name) {
+  auto* bench = benchmark::RegisterBenchmark(name.c_str(), RunScanOrdersBenchmark<Container>);
+  bench->UseManualTime();
+  for (auto size : kSizes) {
+    bench->Arg(static_cast<int>(size));
+  }
+}
+
 template <typename Container>
 void RegisterRangeViewBenchmarks(const std::string& prefix) {
   auto* contiguous = benchmark::RegisterBenchmark(
@@ -540,7 +1665,7 @@ void RegisterRangeViewBenchmarks(const std::string& prefix) {
       [](benchmark::State& state) {
         RunRangeIterationBenchmark<Container>(
             state, [](const Container& cont, std::int64_t lower, std::int64_t upper) {
-              if constexpr (std::is_same_v<Container, OrderVolumeBreakdown>) {
+              if constexpr (kHasVolumeRange<Container>) {
                 auto range = cont.volume_range(lower, upper);
                 return std::make_pair(range.first, range.second);
               } else {
@@ -567,6 +1692,28 @@ void RegisterRangeViewBenchmarks(const std::string& prefix) {
   for (auto size : kSizes) {
     contiguous->Arg(static_cast<int>(size));
   }
+
+  // Same thresholds every pass, searched from a cursor that follows the book through the
+  // erase and push_back before each query.
+  if constexpr (requires(Container& cont) { cont.volume_cursor(); }) {
+    auto* cursor = benchmark::RegisterBenchmark(
+        (prefix + "/RangeIter/Cursor").c_str(),
+        [](benchmark::State& state) {
+          using Cursor = decltype(std::declval<Container&>().volume_cursor());
+          RunRangeIterationBenchmark<Container>(
+              state, [resume = std::optional<Cursor>()](
+                         Container& cont, std::int64_t lower, std::int64_t upper) mutable {
+                if (!resume) {
+                  resume = cont.volume_cursor();
+                }
+                return std::as_const(cont).volume_range(*resume, lower, upper);
+              });
+        });
+    cursor->UseManualTime();
+    for (auto size : kSizes) {
+      cursor->Arg(static_cast<int>(size));
+    }
+  }
 }
 
 template <typename Container>
@@ -578,7 +1725,7 @@ void RegisterFixedSliceRangeBenchmarks(const std::string& prefix) {
           RunCumsumSliceRangeBenchmark<Container>(
               state, slice,
               [](const Container& cont, std::int64_t lower, std::int64_t upper) {
-                if constexpr (std::is_same_v<Container, OrderVolumeBreakdown>) {
+                if constexpr (kHasVolumeRange<Container>) {
                   auto range = cont.volume_range(lower, upper);
                   return std::make_pair(range.first, range.second);
                 } else {
@@ -611,27 +1758,133 @@ int main(int argc, char** argv) {
   ::benchmark::Initialize(&argc, argv);
 
   RegisterBenchmarks<std::vector<Order>>("Vector/StdLowerBound", StdLowerBoundSearch);
+  RegisterIdSearchBenchmarks<StdIdSearch>("Vector/IdStdLowerBound");
+  RegisterIdSearchBenchmarks<BranchlessIdSearch>("Vector/Branchless");
+  RegisterIdSearchBenchmarks<EytzingerIdSearch>("Vector/Eytzinger");
+  RegisterIdSearchBenchmarks<BTreeIdSearch>("Vector/BTree");
+  RegisterIdIndexBenchmarks<StdIdSearch>("StdLowerBound");
+  RegisterIdIndexBenchmarks<EytzingerIdSearch>("Eytzinger");
+  RegisterIdIndexBenchmarks<HashIdSearch>("Hash");
+  RegisterIdIndexBenchmarks<PgmIdSearch>("PGM");
+  RegisterSTreeBenchmarks<8>("STree8");
+  RegisterSTreeBenchmarks<16>("STree16");
 
   RegisterBenchmarks<std::deque<Order>>("Deque/StdLowerBound", StdLowerBoundSearch);
 
   RegisterBenchmarks<VecDeque<Order>>("VecDeque/StdLowerBound", StdLowerBoundSearch);
+  RegisterBenchmarks<VecDeque<Order>>("VecDeque/SliceLowerBound", SliceLowerBoundSearch);
+  RegisterBenchmarks<MirroredOrderDeque>("MirroredVecDeque/StdLowerBound", StdLowerBoundSearch);
+  RegisterBenchmarks<MirroredOrderDeque>("MirroredVecDeque/SliceLowerBound",
+                                         SliceLowerBoundSearch);
   RegisterBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown/Find", VolumeBreakdownFindSearch);
+  RegisterQueryBenchmarks<std::vector<Order>>("Vector/StdLowerBound", StdLowerBoundSearch);
+  RegisterQueryBenchmarks<std::vector<Order>>("Vector/Interpolation", InterpolationSearch);
+  RegisterQueryBenchmarks<std::vector<Order>>("Vector/Gallop", GallopSearch);
+  RegisterQueryBenchmarks<VecDeque<Order>>("VecDeque/SliceLowerBound", SliceLowerBoundSearch);
+  RegisterQueryBenchmarks<VecDeque<Order>>("VecDeque/Interpolation", InterpolationSearch);
+  RegisterQueryBenchmarks<VecDeque<Order>>("VecDeque/Gallop", GallopSearch);
+  RegisterQueryBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown/Find", VolumeBreakdownFindSearch);
+  RegisterQueryBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown/Interpolation",
+                                                InterpolationSearch);
+  RegisterQueryBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown/Gallop", GallopSearch);
+  RegisterQueryBenchmarks<FingerVolumeBreakdown>("VolumeBreakdown/FingerFind",
+                                                 VolumeBreakdownFindSearch);
+  RegisterFingerBenchmarks<VecDeque<Order>>("VecDeque/FindById");
+  RegisterFingerBenchmarks<FingerOrderDeque>("VecDeque/FingerFindById");
+  RegisterFingerBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown/Find");
+  RegisterFingerBenchmarks<FingerVolumeBreakdown>("VolumeBreakdown/FingerFind");
+  RegisterFindManyBenchmarks<std::vector<Order>>("Vector");
+  RegisterFindManyBenchmarks<VecDeque<Order>>("VecDeque");
+  RegisterFindManyBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown");
+  RegisterBenchmarks<std::vector<Order>>("UnchurnedVector/StdLowerBound", StdLowerBoundSearch,
+                                         false);
+  RegisterBenchmarks<VecDeque<Order>>("UnchurnedVecDeque/StdLowerBound", StdLowerBoundSearch,
+                                      false);
+  RegisterBenchmarks<VecDeque<Order>>("UnchurnedVecDeque/SliceLowerBound", SliceLowerBoundSearch,
+                                      false);
+  RegisterBenchmarks<OrderVolumeBreakdown>("UnchurnedVolumeBreakdown/Find",
+                                           VolumeBreakdownFindSearch, false);
+  RegisterBenchmarks<CompactOrderVector>("CompactVector/StdLowerBound", StdLowerBoundSearch);
+  RegisterBenchmarks<CompactOrderDeque>("CompactVecDeque/StdLowerBound", StdLowerBoundSearch);
+  RegisterBenchmarks<CompactOrderDeque>("CompactVecDeque/SliceLowerBound", SliceLowerBoundSearch);
+  RegisterBenchmarks<CompactVolumeBreakdown>("CompactVolumeBreakdown/Find",
+                                             VolumeBreakdownFindSearch);
+  RegisterBenchmarks<HotColdVector>("HotColdVector/StdLowerBound", StdLowerBoundSearch);
+  RegisterBenchmarks<HotColdVecDeque>("HotColdVecDeque/StdLowerBound", StdLowerBoundSearch);
+  RegisterBenchmarks<HotColdVecDeque>("HotColdVecDeque/SliceLowerBound", SliceLowerBoundSearch);
+  RegisterBenchmarks<HotColdVolumeBreakdown>("HotColdVolumeBreakdown/Find",
+                                             VolumeBreakdownFindSearch);
+  RegisterScanBenchmarks<std::vector<Order>>("Vector/Scan");
+  RegisterScanBenchmarks<std::deque<Order>>("Deque/Scan");
+  RegisterScanBenchmarks<VecDeque<Order>>("VecDeque/Scan");
+  RegisterScanBenchmarks<MirroredOrderDeque>("MirroredVecDeque/Scan");
+  RegisterScanBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown/Scan");
+  RegisterScanBenchmarks<std::vector<Order>>("UnchurnedVector/Scan", false);
+  RegisterScanBenchmarks<VecDeque<Order>>("UnchurnedVecDeque/Scan", false);
+  RegisterScanBenchmarks<OrderVolumeBreakdown>("UnchurnedVolumeBreakdown/Scan", false);
+  RegisterScanBenchmarks<CompactOrderVector>("CompactVector/Scan");
+  RegisterScanBenchmarks<CompactOrderDeque>("CompactVecDeque/Scan");
+  RegisterScanBenchmarks<CompactVolumeBreakdown>("CompactVolumeBreakdown/Scan");
+  RegisterScanBenchmarks<HotColdVector>("HotColdVector/Scan");
+  RegisterScanBenchmarks<HotColdVecDeque>("HotColdVecDeque/Scan");
+  RegisterScanBenchmarks<HotColdVolumeBreakdown>("HotColdVolumeBreakdown/Scan");
+  RegisterScanOrdersBenchmarks<std::vector<Order>>("Vector/ScanOrders");
+  RegisterScanOrdersBenchmarks<VecDeque<Order>>("VecDeque/ScanOrders");
+  RegisterScanOrdersBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown/ScanOrders");
+  RegisterScanOrdersBenchmarks<HotColdVector>("HotColdVector/ScanOrders");
+  RegisterScanOrdersBenchmarks<HotColdVecDeque>("HotColdVecDeque/ScanOrders");
+  RegisterScanOrdersBenchmarks<HotColdVolumeBreakdown>("HotColdVolumeBreakdown/ScanOrders");
   RegisterRangeViewBenchmarks<std::vector<Order>>("Vector");
   RegisterRangeViewBenchmarks<std::deque<Order>>("Deque");
   RegisterRangeViewBenchmarks<VecDeque<Order>>("VecDeque");
+  RegisterRangeViewBenchmarks<MirroredOrderDeque>("MirroredVecDeque");
+  RegisterRangeViewBenchmarks<CumulativeOrderDeque>("CumulativeVecDeque");
   RegisterRangeViewBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown");
+  RegisterRangeViewBenchmarks<HotColdVector>("HotColdVector");
+  RegisterRangeViewBenchmarks<HotColdVecDeque>("HotColdVecDeque");
+  RegisterRangeViewBenchmarks<HotColdVolumeBreakdown>("HotColdVolumeBreakdown");
   RegisterFixedSliceRangeBenchmarks<std::vector<Order>>("Vector");
   RegisterFixedSliceRangeBenchmarks<std::deque<Order>>("Deque");
   RegisterFixedSliceRangeBenchmarks<VecDeque<Order>>("VecDeque");
+  RegisterFixedSliceRangeBenchmarks<CumulativeOrderDeque>("CumulativeVecDeque");
   RegisterFixedSliceRangeBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown");
+  RegisterFixedSliceRangeBenchmarks<HotColdVector>("HotColdVector");
+  RegisterFixedSliceRangeBenchmarks<HotColdVecDeque>("HotColdVecDeque");
+  RegisterFixedSliceRangeBenchmarks<HotColdVolumeBreakdown>("HotColdVolumeBreakdown");
 
   RegisterRemoveBenchmarks<std::vector<Order>>("Vector/RemoveMiddle");
   RegisterRemoveBenchmarks<std::deque<Order>>("Deque/RemoveMiddle");
   RegisterRemoveBenchmarks<VecDeque<Order>>("VecDeque/RemoveMiddle");
+  RegisterRemoveBenchmarks<MirroredOrderDeque>("MirroredVecDeque/RemoveMiddle");
+  RegisterRemoveBenchmarks<CumulativeOrderDeque>("CumulativeVecDeque/RemoveMiddle");
   RegisterRemoveBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown/RemoveMiddle");
+  RegisterRemoveBenchmarks<HotColdVector>("HotColdVector/RemoveMiddle");
+  RegisterRemoveBenchmarks<HotColdVecDeque>("HotColdVecDeque/RemoveMiddle");
+  RegisterRemoveBenchmarks<HotColdVolumeBreakdown>("HotColdVolumeBreakdown/RemoveMiddle");
   RegisterSteadyPushPopBenchmarks<std::deque<Order>>("Deque/Steady");
   RegisterSteadyPushPopBenchmarks<VecDeque<Order>>("VecDeque/Steady");
+  RegisterSteadyPushPopBenchmarks<CumulativeOrderDeque>("CumulativeVecDeque/Steady");
   RegisterSteadyPushPopBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown/Steady");
+  RegisterSteadyPushPopBenchmarks<HotColdVecDeque>("HotColdVecDeque/Steady");
+  RegisterSteadyPushPopBenchmarks<HotColdVolumeBreakdown>("HotColdVolumeBreakdown/Steady");
+  RegisterAllocatorBenchmarks<VecDequeLevel>("VecDeque");
+  RegisterAllocatorBenchmarks<VolumeBreakdownLevel>("VolumeBreakdown");
+  RegisterSmallLevelBenchmarks<VecDeque<Order>>("VecDeque/SmallLevels");
+  RegisterSmallLevelBenchmarks<InlineOrderDeque>("InlineVecDeque/SmallLevels");
+  RegisterOrderStreamBenchmarks();
+  RegisterGenerateBenchmarks("OrderGenerator/Generate/Threads");
+  RegisterOrderFlowBenchmarks<std::vector<Order>>("Vector");
+  RegisterOrderFlowBenchmarks<std::deque<Order>>("Deque");
+  RegisterOrderFlowBenchmarks<VecDeque<Order>>("VecDeque");
+  RegisterOrderFlowBenchmarks<MirroredOrderDeque>("MirroredVecDeque");
+  RegisterOrderFlowBenchmarks<CumulativeOrderDeque>("CumulativeVecDeque");
+  RegisterOrderFlowBenchmarks<OrderVolumeBreakdown>("VolumeBreakdown");
+  RegisterOrderFlowBenchmarks<HotColdVector>("HotColdVector");
+  RegisterOrderFlowBenchmarks<HotColdVecDeque>("HotColdVecDeque");
+  RegisterOrderFlowBenchmarks<HotColdVolumeBreakdown>("HotColdVolumeBreakdown");
+  RegisterBookManagerBenchmarks("BookManager/Replay/Shards");
+  RegisterSpscHandoffBenchmarks<BusyPollWait>("SpscQueue/BusyPoll/Batch");
+  RegisterSpscHandoffBenchmarks<FutexWait>("SpscQueue/Futex/Batch");
 
   ::benchmark::RunSpecifiedBenchmarks();
   ::benchmark::Shutdown();
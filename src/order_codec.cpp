@@ -0,0 +1,261 @@
+#include "order_codec.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+static_assert(std::endian::native == std::endian::little,
+              "the order codec loads its little-endian varints with plain word loads");
+
+namespace {
+
+constexpr std::size_t kHeaderBytes = sizeof(std::uint64_t);
+// Largest span of data bytes one order's word loads can touch: its id and timestamp bytes are
+// read as one 16-byte block, and its volume word as 8 bytes starting at most 16 bytes in.
+constexpr std::size_t kMaxLoadBytes = 24;
+constexpr std::array<std::uint8_t, 4> kVolumeLengths{1, 2, 3, 5};
+
+// kByteMasks[n] keeps the low n bytes of a word; a load is cheaper than a shift by a variable.
+constexpr std::array<std::uint64_t, 9> kByteMasks = [] {
+  std::array<std::uint64_t, 9> masks{};
+  for (unsigned n = 1; n < masks.size(); ++n) {
+    masks[n] = ~std::uint64_t{0} >> (64 - 8 * n);
+  }
+  return masks;
+}();
+
+// Everything the decoders need from one control byte.
+struct alignas(32) ControlEntry {
+  // Moves the id bytes into lane 0 and the timestamp bytes into lane 1, zero-extended.
+  std::array<std::uint8_t, 16> shuffle;
+  std::uint64_t volume_mask;
+  std::uint8_t id_length;
+  std::uint8_t timestamp_length;
+  std::uint8_t volume_offset;
+  std::uint8_t length;
+};
+
+constexpr std::array<ControlEntry, 256> make_control_table() {
+  std::array<ControlEntry, 256> table{};
+  for (unsigned control = 0; control < table.size(); ++control) {
+    ControlEntry& entry = table[control];
+    const unsigned id_length = (control & 7) + 1;
+    const unsigned timestamp_length = ((control >> 3) & 7) + 1;
+    const unsigned volume_length = kVolumeLengths[control >> 6];
+    for (unsigned b = 0; b < 8; ++b) {
+      entry.shuffle[b] = static_cast<std::uint8_t>(b < id_length ? b : 0x80);
+      entry.shuffle[8 + b] =
+          static_cast<std::uint8_t>(b < timestamp_length ? id_length + b : 0x80);
+    }
+    entry.volume_mask = kByteMasks[volume_length];
+    entry.id_length = static_cast<std::uint8_t>(id_length);
+    entry.timestamp_length = static_cast<std::uint8_t>(timestamp_length);
+    entry.volume_offset = static_cast<std::uint8_t>(id_length + timestamp_length);
+    entry.length = static_cast<std::uint8_t>(id_length + timestamp_length + volume_length);
+  }
+  return table;
+}
+
+constexpr std::array<ControlEntry, 256> kControlTable = make_control_table();
+
+std::uint64_t zigzag(std::int64_t value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value) {
+  return static_cast<std::int64_t>((value >> 1) ^ (0 - (value & 1)));
+}
+
+unsigned byte_length(std::uint64_t value) {
+  return value == 0 ? 1 : static_cast<unsigned>((std::bit_width(value) + 7) / 8);
+}
+
+void store_word(std::uint8_t* bytes, std::uint64_t word) {
+  std::memcpy(bytes, &word, sizeof(word));
+}
+
+std::uint64_t load_word(const std::uint8_t* bytes) {
+  std::uint64_t word;
+  std::memcpy(&word, bytes, sizeof(word));
+  return word;
+}
+
+std::uint64_t load_bytes(const std::uint8_t* bytes, unsigned length) {
+  std::uint64_t value = 0;
+  for (unsigned b = 0; b < length; ++b) {
+    value |= static_cast<std::uint64_t>(bytes[b]) << (8 * b);
+  }
+  return value;
+}
+
+Order make_order(std::uint64_t id, std::uint64_t timestamp, std::uint64_t volume_word) {
+  const auto volume = static_cast<std::uint32_t>(volume_word >> 1);
+  return Order{id, timestamp, static_cast<std::int32_t>((volume >> 1) ^ (0u - (volume & 1))),
+               (volume_word & 1) != 0};
+}
+
+struct Cursor {
+  std::size_t position;
+  std::uint64_t id;
+  std::uint64_t timestamp;
+};
+
+// Decodes orders while all of their loads stay inside the data; returns how many it decoded.
+std::size_t decode_words(Cursor& cursor,
+                         const std::uint8_t* controls,
+                         const std::uint8_t* data,
+                         std::size_t data_size,
+                         Order* out,
+                         std::size_t count) {
+  Cursor c = cursor;
+  std::size_t i = 0;
+  for (; i < count && c.position + kMaxLoadBytes <= data_size; ++i) {
+    const ControlEntry& entry = kControlTable[controls[i]];
+    const std::uint8_t* bytes = data + c.position;
+    c.id += load_word(bytes) & kByteMasks[entry.id_length];
+    c.timestamp += static_cast<std::uint64_t>(
+        unzigzag(load_word(bytes + entry.id_length) & kByteMasks[entry.timestamp_length]));
+    const std::uint64_t volume_word = load_word(bytes + entry.volume_offset) & entry.volume_mask;
+    c.position += entry.length;
+    out[i] = make_order(c.id, c.timestamp, volume_word);
+  }
+  cursor = c;
+  return i;
+}
+
+#if defined(__x86_64__)
+[[gnu::target("ssse3")]] std::size_t decode_ssse3(Cursor& cursor,
+                                                  const std::uint8_t* controls,
+                                                  const std::uint8_t* data,
+                                                  std::size_t data_size,
+                                                  Order* out,
+                                                  std::size_t count) {
+  Cursor c = cursor;
+  std::size_t i = 0;
+  for (; i < count && c.position + kMaxLoadBytes <= data_size; ++i) {
+    const ControlEntry& entry = kControlTable[controls[i]];
+    const std::uint8_t* bytes = data + c.position;
+    const __m128i deltas = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes)),
+        _mm_load_si128(reinterpret_cast<const __m128i*>(entry.shuffle.data())));
+    c.id += static_cast<std::uint64_t>(_mm_cvtsi128_si64(deltas));
+    c.timestamp += static_cast<std::uint64_t>(unzigzag(
+        static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(deltas, deltas)))));
+    const std::uint64_t volume_word = load_word(bytes + entry.volume_offset) & entry.volume_mask;
+    c.position += entry.length;
+    out[i] = make_order(c.id, c.timestamp, volume_word);
+  }
+  cursor = c;
+  return i;
+}
+#endif
+
+// The last few orders, whose word loads would run past the end of the stream.
+void decode_bytes(Cursor& cursor,
+                  const std::uint8_t* controls,
+                  const std::uint8_t* data,
+                  Order* out,
+                  std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const ControlEntry& entry = kControlTable[controls[i]];
+    const std::uint8_t* bytes = data + cursor.position;
+    cursor.id += load_bytes(bytes, entry.id_length);
+    cursor.timestamp += static_cast<std::uint64_t>(
+        unzigzag(load_bytes(bytes + entry.id_length, entry.timestamp_length)));
+    const std::uint64_t volume_word =
+        load_bytes(bytes + entry.volume_offset, entry.length - entry.volume_offset);
+    cursor.position += entry.length;
+    out[i] = make_order(cursor.id, cursor.timestamp, volume_word);
+  }
+}
+
+}  // namespace
+
+void OrderStreamWriter::push_back(const Order& order) {
+  const std::uint64_t id_delta = order.id - previous_id_;
+  const std::uint64_t timestamp_delta =
+      zigzag(static_cast<std::int64_t>(order.exchangeTimestamp - previous_timestamp_));
+  const auto volume = static_cast<std::uint32_t>(order.volume);
+  const std::uint32_t zigzag_volume =
+      (volume << 1) ^ static_cast<std::uint32_t>(order.volume >> 31);
+  const std::uint64_t volume_word =
+      (static_cast<std::uint64_t>(zigzag_volume) << 1) | (order.isOwn ? 1u : 0u);
+
+  const unsigned id_length = byte_length(id_delta);
+  const unsigned timestamp_length = byte_length(timestamp_delta);
+  const unsigned volume_class = std::min(byte_length(volume_word), 4u) - 1;
+  controls_.push_back(static_cast<std::uint8_t>((id_length - 1) | (timestamp_length - 1) << 3 |
+                                                volume_class << 6));
+  // Fields are stored as whole words, each overwriting the spare bytes of the one before.
+  if (data_.size() < data_size_ + kMaxLoadBytes) {
+    data_.resize(std::max(2 * data_.size(), data_size_ + kMaxLoadBytes));
+  }
+  std::uint8_t* bytes = data_.data() + data_size_;
+  store_word(bytes, id_delta);
+  store_word(bytes + id_length, timestamp_delta);
+  store_word(bytes + id_length + timestamp_length, volume_word);
+  data_size_ += id_length + timestamp_length + kVolumeLengths[volume_class];
+  previous_id_ = order.id;
+  previous_timestamp_ = order.exchangeTimestamp;
+}
+
+std::vector<std::uint8_t> OrderStreamWriter::finish() {
+  std::vector<std::uint8_t> stream;
+  stream.resize(kHeaderBytes + controls_.size() + data_size_);
+  store_word(stream.data(), controls_.size());
+  std::memcpy(stream.data() + kHeaderBytes, controls_.data(), controls_.size());
+  std::memcpy(stream.data() + kHeaderBytes + controls_.size(), data_.data(), data_size_);
+  *this = OrderStreamWriter{};
+  return stream;
+}
+
+OrderStreamReader::OrderStreamReader(std::span<const std::uint8_t> stream) {
+  assert(stream.size() >= kHeaderBytes);
+  count_ = static_cast<std::size_t>(load_word(stream.data()));
+  assert(stream.size() - kHeaderBytes >= count_);
+  controls_ = stream.data() + kHeaderBytes;
+  data_ = controls_ + count_;
+  data_size_ = stream.size() - kHeaderBytes - count_;
+}
+
+std::size_t OrderStreamReader::read(std::span<Order> out) {
+  const std::size_t count = std::min(out.size(), remaining());
+  Cursor cursor{position_, previous_id_, previous_timestamp_};
+  const std::uint8_t* controls = controls_ + next_;
+  std::size_t done = 0;
+#if defined(__x86_64__)
+  if (use_ssse3_) {
+    done = decode_ssse3(cursor, controls, data_, data_size_, out.data(), count);
+  } else {
+    done = decode_words(cursor, controls, data_, data_size_, out.data(), count);
+  }
+#else
+  done = decode_words(cursor, controls, data_, data_size_, out.data(), count);
+#endif
+  decode_bytes(cursor, controls + done, data_, out.data() + done, count - done);
+  position_ = cursor.position;
+  previous_id_ = cursor.id;
+  previous_timestamp_ = cursor.timestamp;
+  next_ += count;
+  return count;
+}
+
+std::vector<std::uint8_t> encode_orders(std::span<const Order> orders) {
+  OrderStreamWriter writer;
+  for (const Order& order : orders) {
+    writer.push_back(order);
+  }
+  return writer.finish();
+}
+
+std::vector<Order> decode_orders(std::span<const std::uint8_t> stream) {
+  OrderStreamReader reader(stream);
+  std::vector<Order> orders(reader.size());
+  reader.read(orders);
+  return orders;
+}
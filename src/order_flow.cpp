@@ -0,0 +1,193 @@
+#include "order_flow.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <limits>
+
+OrderFlowGenerator::OrderFlowGenerator(const OrderFlowConfig& config,
+                                       std::uint64_t seed,
+                                       std::span<const Order> book)
+    : config_(config),
+      generator_(seed),
+      rng_(seed ^ 0x9e37'79b9'7f4a'7c15ull),
+      id_base_(book.empty() ? 0 : book.back().id),
+      now_(book.empty() ? 0 : book.back().exchangeTimestamp) {
+  rebuild(2 * book.size());
+  for (const Order& order : book) {
+    push_slot(order.id, order.volume);
+  }
+}
+
+OrderFlowEvent OrderFlowGenerator::next_event() {
+  using Kind = OrderFlowEvent::Kind;
+  OrderFlowEvent event;
+  event.kind = pick_kind();
+  event.timestamp = next_timestamp();
+  if (event.kind == Kind::Add) {
+    event.order = new_order(0);
+    event.id = event.order.id;
+    event.volume = event.order.volume;
+    push_slot(event.order.id, event.order.volume);
+    return event;
+  }
+
+  const std::size_t slot = slot_at(event.kind == Kind::Execute ? 0 : pick_position());
+  const std::int32_t volume = slots_[slot].volume;
+  event.id = slots_[slot].id;
+  switch (event.kind) {
+    case Kind::ModifyDown:
+      if (volume > 1) {
+        event.volume = std::uniform_int_distribution<std::int32_t>(1, volume - 1)(rng_);
+        slots_[slot].volume = event.volume;
+        break;
+      }
+      // A single-lot order cannot shrink; it is cancelled instead.
+      event.kind = Kind::Cancel;
+      kill_slot(slot);
+      break;
+    case Kind::ModifyUp: {
+      const std::int64_t grown =
+          std::int64_t{volume} + std::uniform_int_distribution<std::int32_t>(1, volume)(rng_);
+      event.volume = static_cast<std::int32_t>(
+          std::min<std::int64_t>(grown, std::numeric_limits<std::int32_t>::max()));
+      kill_slot(slot);
+      event.order = new_order(event.volume);
+      push_slot(event.order.id, event.volume);
+      break;
+    }
+    case Kind::Execute:
+      event.volume = std::min(
+          volume,
+          std::uniform_int_distribution<std::int32_t>(1, config_.max_execute_volume)(rng_));
+      if (event.volume == volume) {
+        kill_slot(slot);
+      } else {
+        slots_[slot].volume -= event.volume;
+      }
+      break;
+    case Kind::Add:
+    case Kind::Cancel:
+      kill_slot(slot);
+      break;
+  }
+  return event;
+}
+
+std::vector<OrderFlowEvent> OrderFlowGenerator::generate(std::size_t count) {
+  std::vector<OrderFlowEvent> events;
+  events.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    events.push_back(next_event());
+  }
+  return events;
+}
+
+void OrderFlowGenerator::push_slot(std::uint64_t id, std::int32_t volume) {
+  if (slots_.size() + 1 >= tree_.size()) {
+    rebuild(2 * (live_ + 1));
+  }
+  slots_.push_back(Slot{id, volume});
+  for (std::size_t i = slots_.size(); i < tree_.size(); i += i & (0 - i)) {
+    ++tree_[i];
+  }
+  ++live_;
+}
+
+void OrderFlowGenerator::kill_slot(std::size_t slot) {
+  slots_[slot].volume = 0;
+  for (std::size_t i = slot + 1; i < tree_.size(); i += i & (0 - i)) {
+    --tree_[i];
+  }
+  --live_;
+}
+
+std::size_t OrderFlowGenerator::slot_at(std::size_t position) const {
+  // Descends the tree to the last index whose live prefix is at most `position`; the slot
+  // after it is the live order at that position.
+  std::size_t index = 0;
+  std::size_t remaining = position + 1;
+  for (std::size_t step = tree_.size() - 1; step > 0; step >>= 1) {
+    const std::size_t next = index + step;
+    if (next < tree_.size() && tree_[next] < remaining) {
+      index = next;
+      remaining -= tree_[next];
+    }
+  }
+  return index;
+}
+
+void OrderFlowGenerator::rebuild(std::size_t capacity) {
+  std::erase_if(slots_, [](const Slot& slot) { return slot.volume == 0; });
+  const std::size_t size =
+      std::bit_ceil(std::max<std::size_t>({capacity, slots_.size() + 1, 64}));
+  tree_.assign(size + 1, 0);
+  for (std::size_t i = 1; i < tree_.size(); ++i) {
+    tree_[i] += i <= slots_.size() ? 1 : 0;
+    const std::size_t parent = i + (i & (0 - i));
+    if (parent < tree_.size()) {
+      tree_[parent] += tree_[i];
+    }
+  }
+}
+
+std::size_t OrderFlowGenerator::pick_position() {
+  switch (config_.cancel_position) {
+    case OrderFlowConfig::Position::PositionZipf:
+      return zipf_position(live_, config_.exponent, rng_);
+    case OrderFlowConfig::Position::Recent: {
+      std::geometric_distribution<std::size_t> age(1.0 / (1.0 + config_.mean_age));
+      return live_ - 1 - std::min(age(rng_), live_ - 1);
+    }
+    case OrderFlowConfig::Position::Uniform:
+      break;
+  }
+  return std::uniform_int_distribution<std::size_t>(0, live_ - 1)(rng_);
+}
+
+OrderFlowEvent::Kind OrderFlowGenerator::pick_kind() {
+  using Kind = OrderFlowEvent::Kind;
+  if (live_ == 0) {
+    return Kind::Add;
+  }
+  const double pull = std::clamp(
+      static_cast<double>(config_.target_size) / static_cast<double>(live_), 0.25, 4.0);
+  const double rates[] = {config_.add_rate * pull, config_.cancel_rate, config_.modify_down_rate,
+                          config_.modify_up_rate, config_.execute_rate};
+  double total = 0.0;
+  for (const double rate : rates) {
+    total += rate;
+  }
+  double u = std::uniform_real_distribution<double>(0.0, total)(rng_);
+  for (std::size_t kind = 0; kind + 1 < std::size(rates); ++kind) {
+    if (u < rates[kind]) {
+      return static_cast<Kind>(kind);
+    }
+    u -= rates[kind];
+  }
+  return Kind::Execute;
+}
+
+std::uint64_t OrderFlowGenerator::next_timestamp() {
+  if (config_.arrival == OrderFlowConfig::Arrival::Bursty) {
+    if (bursting_) {
+      bursting_ = !std::bernoulli_distribution(1.0 / config_.mean_burst_events)(rng_);
+    } else {
+      bursting_ = std::bernoulli_distribution(config_.burst_start)(rng_);
+    }
+  }
+  const double mean_gap = bursting_ ? config_.mean_gap_ns / config_.burst_speedup
+                                    : config_.mean_gap_ns;
+  now_ += static_cast<std::uint64_t>(std::exponential_distribution<double>(1.0 / mean_gap)(rng_));
+  return now_;
+}
+
+Order OrderFlowGenerator::new_order(std::int32_t volume) {
+  Order order = generator_.next_order();
+  order.id += id_base_;
+  order.exchangeTimestamp = now_;
+  if (volume > 0) {
+    order.volume = volume;
+  }
+  return order;
+}
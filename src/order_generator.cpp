@@ -1,50 +1,288 @@
 #include "order_generator.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <random>
+#include <thread>
 
-OrderGenerator::OrderGenerator(std::uint64_t seed)
-    : rng_{seed}, nextId_{1}, baseTimestamp_{1'000'000} {}
+namespace {
 
-Order OrderGenerator::next_order() {
+constexpr std::uint64_t kGoldenGamma = 0x9e3779b97f4a7c15ull;
+// Orders whose draws are computed together before the id scan.
+constexpr std::size_t kDrawBlock = 256;
+
+// SplitMix64 output for counter `index` of the stream `seed`.
+std::uint64_t draw(std::uint64_t seed, std::uint64_t index) {
+  std::uint64_t z = seed + (index + 1) * kGoldenGamma;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+// Bits of a draw: 0-1 id step, 2 isOwn, 3-18 timestamp jitter, 32-63 volume.
+std::uint64_t id_step(std::uint64_t bits) { return 1 + (bits & 0x3); }
+
+Order make_order(std::uint64_t bits, std::uint64_t id, std::uint64_t base_timestamp) {
   Order order;
-  order.id = nextId_;
-  nextId_ += 1 + static_cast<std::uint64_t>(rng_() & 0x3);
-  order.exchangeTimestamp = baseTimestamp_ + (order.id << 5) + (rng_() & 0xFFFF);
-  order.volume = static_cast<std::int32_t>(1 + (rng_() % 2000));
-  order.isOwn = (rng_() & 0x1) == 0;
+  order.id = id;
+  order.exchangeTimestamp = base_timestamp + (id << 5) + ((bits >> 3) & 0xFFFF);
+  order.volume = static_cast<std::int32_t>(1 + (((bits >> 32) * 2000) >> 32));
+  order.isOwn = ((bits >> 2) & 0x1) == 0;
   return order;
 }
 
-std::vector<Order> OrderGenerator::generate(std::size_t count) {
-  std::vector<Order> out;
-  out.reserve(count);
+// The draw loops carry no dependency from one counter to the next, so they vectorize; AVX2
+// gives four lanes (each 64-bit multiply built from vpmuludq), picked at run time.
+[[gnu::always_inline]] inline void fill_draws_impl(std::uint64_t seed,
+                                                    std::uint64_t first,
+                                                    std::size_t count,
+                                                    std::uint64_t* out) {
   for (std::size_t i = 0; i < count; ++i) {
-    out.push_back(next_order());
+    out[i] = draw(seed, first + i);
+  }
+}
+
+[[gnu::always_inline]] inline std::uint64_t sum_id_steps_impl(std::uint64_t seed,
+                                                               std::uint64_t first,
+                                                               std::size_t count) {
+  std::uint64_t sum = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    sum += id_step(draw(seed, first + i));
+  }
+  return sum;
+}
+
+#if defined(__x86_64__)
+[[gnu::target("avx2")]] void fill_draws_avx2(std::uint64_t seed,
+                                             std::uint64_t first,
+                                             std::size_t count,
+                                             std::uint64_t* out) {
+  fill_draws_impl(seed, first, count, out);
+}
+
+[[gnu::target("avx2")]] std::uint64_t sum_id_steps_avx2(std::uint64_t seed,
+                                                        std::uint64_t first,
+                                                        std::size_t count) {
+  return sum_id_steps_impl(seed, first, count);
+}
+
+const bool use_avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+
+void fill_draws(std::uint64_t seed, std::uint64_t first, std::size_t count, std::uint64_t* out) {
+#if defined(__x86_64__)
+  if (use_avx2) {
+    fill_draws_avx2(seed, first, count, out);
+    return;
+  }
+#endif
+  fill_draws_impl(seed, first, count, out);
+}
+
+std::uint64_t sum_id_steps(std::uint64_t seed, std::uint64_t first, std::size_t count) {
+#if defined(__x86_64__)
+  if (use_avx2) {
+    return sum_id_steps_avx2(seed, first, count);
+  }
+#endif
+  return sum_id_steps_impl(seed, first, count);
+}
+
+// Runs fn(0) .. fn(threads - 1), all but the first on new threads.
+template <typename Fn>
+void run_shares(std::size_t threads, Fn fn) {
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (std::size_t t = 1; t < threads; ++t) {
+    workers.emplace_back(fn, t);
+  }
+  fn(0);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace
+
+OrderGenerator::OrderGenerator(std::uint64_t seed)
+    : seed_{seed}, counter_{0}, nextId_{1}, baseTimestamp_{1'000'000} {}
+
+Order OrderGenerator::next_order() {
+  const std::uint64_t bits = draw(seed_, counter_++);
+  const Order order = make_order(bits, nextId_, baseTimestamp_);
+  nextId_ += id_step(bits);
+  return order;
+}
+
+std::uint64_t OrderGenerator::fill(Order* out,
+                                   std::uint64_t first,
+                                   std::size_t count,
+                                   std::uint64_t id) const {
+  std::array<std::uint64_t, kDrawBlock> draws;
+  for (std::size_t done = 0; done < count; done += kDrawBlock) {
+    const std::size_t n = std::min(kDrawBlock, count - done);
+    fill_draws(seed_, first + done, n, draws.data());
+    for (std::size_t j = 0; j < n; ++j) {
+      out[done + j] = make_order(draws[j], id, baseTimestamp_);
+      id += id_step(draws[j]);
+    }
+  }
+  return id;
+}
+
+std::uint64_t OrderGenerator::id_span(std::uint64_t first, std::size_t count) const {
+  return sum_id_steps(seed_, first, count);
+}
+
+std::vector<Order> OrderGenerator::generate(std::size_t count) { return generate(count, 1); }
+
+std::vector<Order> OrderGenerator::generate(std::size_t count, std::size_t threads) {
+  std::vector<Order> out(count);
+  threads = std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(1, count / kDrawBlock));
+  // Share t covers orders [bounds[t], bounds[t + 1]) and starts at id first_ids[t].
+  std::vector<std::size_t> bounds(threads + 1);
+  for (std::size_t t = 0; t <= threads; ++t) {
+    bounds[t] = count * t / threads;
   }
+  std::vector<std::uint64_t> first_ids(threads + 1, 0);
+  first_ids[0] = nextId_;
+  if (threads > 1) {
+    run_shares(threads - 1, [&](std::size_t t) {
+      first_ids[t + 1] = id_span(counter_ + bounds[t], bounds[t + 1] - bounds[t]);
+    });
+    for (std::size_t t = 1; t < threads; ++t) {
+      first_ids[t] += first_ids[t - 1];
+    }
+  }
+  run_shares(threads, [&](std::size_t t) {
+    const std::uint64_t end_id = fill(out.data() + bounds[t], counter_ + bounds[t],
+                                      bounds[t + 1] - bounds[t], first_ids[t]);
+    if (t + 1 == threads) {
+      first_ids[threads] = end_id;
+    }
+  });
+  counter_ += count;
+  nextId_ = first_ids[threads];
   return out;
 }
 
+std::size_t zipf_position(std::size_t n, double exponent, std::mt19937_64& rng) {
+  const double size = static_cast<double>(n);
+  const double s = exponent;
+  const double total =
+      s == 1.0 ? std::log(size + 1.0) : (std::pow(size + 1.0, 1.0 - s) - 1.0) / (1.0 - s);
+  const double u = std::uniform_real_distribution<double>(0.0, total)(rng);
+  const double x = s == 1.0 ? std::exp(u) : std::pow(1.0 + u * (1.0 - s), 1.0 / (1.0 - s));
+  return std::min(static_cast<std::size_t>(x) - 1, n - 1);
+}
+
 std::vector<std::uint64_t> make_query_ids(const std::vector<Order>& orders,
                                           std::size_t count,
-                                          double hit_ratio,
+                                          const QueryDistribution& distribution,
                                           std::mt19937_64& rng) {
+  using Pick = QueryDistribution::Pick;
   std::vector<std::uint64_t> ids;
   ids.reserve(count);
   if (orders.empty()) {
     return ids;
   }
-  std::bernoulli_distribution hit(hit_ratio);
-  std::uniform_int_distribution<std::size_t> hit_dist(0, orders.size() - 1);
+  const std::size_t n = orders.size();
+  std::bernoulli_distribution hit(distribution.hit_ratio);
+  std::uniform_int_distribution<std::size_t> uniform(0, n - 1);
+  std::geometric_distribution<std::size_t> age(1.0 / (1.0 + distribution.mean_age));
   const std::uint64_t miss_base = orders.back().id + 1;
   std::uniform_int_distribution<std::uint64_t> miss_offset(1, orders.back().id);
 
+  std::vector<std::size_t> working_set;
+  std::discrete_distribution<std::size_t> rank;
+  if (distribution.pick == Pick::Own && distribution.working_set > 0) {
+    std::vector<std::size_t> own;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (orders[i].isOwn) {
+        own.push_back(i);
+      }
+    }
+    std::uniform_int_distribution<std::size_t> own_pick(0, own.empty() ? n - 1 : own.size() - 1);
+    std::vector<double> weights(distribution.working_set);
+    for (std::size_t r = 0; r < weights.size(); ++r) {
+      working_set.push_back(own.empty() ? own_pick(rng) : own[own_pick(rng)]);
+      weights[r] = 1.0 / std::pow(static_cast<double>(r + 1), distribution.exponent);
+    }
+    rank = std::discrete_distribution<std::size_t>(weights.begin(), weights.end());
+  }
+
+  const auto pick_index = [&]() -> std::size_t {
+    switch (distribution.pick) {
+      case Pick::PositionZipf:
+        return zipf_position(n, distribution.exponent, rng);
+      case Pick::Recent:
+        return n - 1 - std::min(age(rng), n - 1);
+      case Pick::Own:
+        if (!working_set.empty()) {
+          return working_set[rank(rng)];
+        }
+        break;
+      case Pick::Uniform:
+        break;
+    }
+    return uniform(rng);
+  };
+
   for (std::size_t i = 0; i < count; ++i) {
-    if (hit(rng)) {
-      ids.push_back(orders[hit_dist(rng)].id);
-    } else {
+    const bool is_hit = hit(rng);
+    if (!is_hit && distribution.miss == QueryDistribution::Miss::AboveRange) {
       ids.push_back(miss_base + miss_offset(rng));
+      continue;
     }
+    std::size_t index = pick_index();
+    if (is_hit) {
+      ids.push_back(orders[index].id);
+      continue;
+    }
+    // Duplicate ids (a churned book reuses low ids) are stepped over like any other.
+    std::uint64_t id = orders[index].id + 1;
+    while (index + 1 < n && orders[index + 1].id <= id) {
+      ++index;
+      if (orders[index].id == id) {
+        ++id;
+      }
+    }
+    ids.push_back(id);
   }
   return ids;
 }
+
+std::vector<std::uint64_t> make_query_ids(const std::vector<Order>& orders,
+                                          std::size_t count,
+                                          double hit_ratio,
+                                          std::mt19937_64& rng) {
+  QueryDistribution distribution;
+  distribution.hit_ratio = hit_ratio;
+  return make_query_ids(orders, count, distribution, rng);
+}
+
+std::vector<std::uint64_t> make_recent_query_ids(const std::vector<Order>& orders,
+                                                 std::size_t count,
+                                                 double hit_ratio,
+                                                 double mean_age,
+                                                 std::mt19937_64& rng) {
+  QueryDistribution distribution;
+  distribution.pick = QueryDistribution::Pick::Recent;
+  distribution.hit_ratio = hit_ratio;
+  distribution.mean_age = mean_age;
+  return make_query_ids(orders, count, distribution, rng);
+}
+
+std::vector<std::uint64_t> make_zipf_query_ids(const std::vector<Order>& orders,
+                                               std::size_t count,
+                                               std::size_t working_set,
+                                               double exponent,
+                                               std::mt19937_64& rng) {
+  QueryDistribution distribution;
+  distribution.pick = QueryDistribution::Pick::Own;
+  distribution.hit_ratio = 1.0;
+  distribution.exponent = exponent;
+  distribution.working_set = working_set;
+  return make_query_ids(orders, count, distribution, rng);
+}